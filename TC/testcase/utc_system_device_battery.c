@@ -16,6 +16,8 @@
  * 
  */
 #include <tet_api.h>
+#include <stdio.h>
+#include <unistd.h>
 #include <device.h>
 
 #define API_NAME_DEVICE_BATTERY_GET_PERCENT "device_battery_get_percent"
@@ -23,6 +25,19 @@
 #define API_NAME_DEVICE_BATTERY_IS_CHARGING "device_battery_is_charging"
 #define API_NAME_DEVICE_BATTERY_SET_CB "device_battery_set_cb"
 #define API_NAME_DEVICE_BATTERY_UNSET_CB "device_battery_unset_cb"
+#define API_NAME_DEVICE_QUERY "device_query"
+#define API_NAME_DEVICE_CHANGES_SINCE "device_changes_since"
+#define API_NAME_DEVICE_CALLBACK_GET_STATS "device_callback_get_stats"
+#define API_NAME_DEVICE_CALLBACK_SET_EXECUTOR "device_callback_set_executor"
+#define API_NAME_DEVICE_BATTERY_SET_BATCH_CB "device_battery_set_batch_cb"
+#define API_NAME_DEVICE_BATTERY_WARNING_SET_LEVEL_CB "device_battery_warning_set_level_cb"
+#define API_NAME_DEVICE_BATTERY_SET_DETAIL_CB "device_battery_set_detail_cb"
+#define API_NAME_DEVICE_BATTERY_HISTORY_FOREACH "device_battery_history_foreach"
+#define API_NAME_DEVICE_BATTERY_SERIES_AGGREGATE "device_battery_series_aggregate"
+#define API_NAME_DEVICE_BATTERY_SERIES_GET_INDEX "device_battery_series_get_index"
+#define API_NAME_DEVICE_WAIT_ONCE "device_wait_once"
+
+#define HISTORY_PATH "/tmp/utc_system_device_battery.hist"
 
 static void startup(void);
 static void cleanup(void);
@@ -39,6 +54,27 @@ static void utc_system_device_battery_is_charging_n(void);
 static void utc_system_device_battery_set_cb_p(void);
 static void utc_system_device_battery_set_cb_n(void);
 static void utc_system_device_battery_unset_cb_p(void);
+static void utc_system_device_battery_set_batch_cb_p(void);
+static void utc_system_device_battery_set_batch_cb_n(void);
+static void utc_system_device_battery_warning_set_level_cb_p(void);
+static void utc_system_device_battery_warning_set_level_cb_n(void);
+static void utc_system_device_battery_set_detail_cb_p(void);
+static void utc_system_device_battery_set_detail_cb_n(void);
+static void utc_system_device_battery_history_foreach_p(void);
+static void utc_system_device_battery_history_foreach_n(void);
+static void utc_system_device_battery_series_aggregate_p(void);
+static void utc_system_device_battery_series_aggregate_n(void);
+static void utc_system_device_battery_series_get_index_p(void);
+static void utc_system_device_query_p(void);
+static void utc_system_device_query_n(void);
+static void utc_system_device_changes_since_p(void);
+static void utc_system_device_changes_since_n(void);
+static void utc_system_device_callback_get_stats_p(void);
+static void utc_system_device_callback_get_stats_n(void);
+static void utc_system_device_callback_set_executor_p(void);
+static void utc_system_device_callback_set_executor_n(void);
+static void utc_system_device_wait_once_p(void);
+static void utc_system_device_wait_once_n(void);
 
 
 enum {
@@ -56,6 +92,27 @@ struct tet_testlist tet_testlist[] = {
 	{ utc_system_device_battery_set_cb_p, POSITIVE_TC_IDX },
 	{ utc_system_device_battery_set_cb_n, NEGATIVE_TC_IDX },
 	{ utc_system_device_battery_unset_cb_p, POSITIVE_TC_IDX },
+	{ utc_system_device_battery_set_batch_cb_p, POSITIVE_TC_IDX },
+	{ utc_system_device_battery_set_batch_cb_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_battery_warning_set_level_cb_p, POSITIVE_TC_IDX },
+	{ utc_system_device_battery_warning_set_level_cb_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_battery_set_detail_cb_p, POSITIVE_TC_IDX },
+	{ utc_system_device_battery_set_detail_cb_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_battery_history_foreach_p, POSITIVE_TC_IDX },
+	{ utc_system_device_battery_history_foreach_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_battery_series_aggregate_p, POSITIVE_TC_IDX },
+	{ utc_system_device_battery_series_aggregate_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_battery_series_get_index_p, POSITIVE_TC_IDX },
+	{ utc_system_device_query_p, POSITIVE_TC_IDX },
+	{ utc_system_device_query_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_changes_since_p, POSITIVE_TC_IDX },
+	{ utc_system_device_changes_since_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_callback_get_stats_p, POSITIVE_TC_IDX },
+	{ utc_system_device_callback_get_stats_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_callback_set_executor_p, POSITIVE_TC_IDX },
+	{ utc_system_device_callback_set_executor_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_wait_once_p, POSITIVE_TC_IDX },
+	{ utc_system_device_wait_once_n, NEGATIVE_TC_IDX },
 	{ NULL, 0},
 };
 
@@ -154,3 +211,330 @@ static void utc_system_device_battery_unset_cb_p(void)
     int error = device_battery_unset_cb();
     dts_check_eq(API_NAME_DEVICE_BATTERY_SET_CB, error, DEVICE_ERROR_NONE);
 }
+
+static void battery_batch_cb(unsigned int changes, const device_battery_state_s *state, void *user_data)
+{
+}
+
+static void utc_system_device_battery_set_batch_cb_p(void)
+{
+    int error = device_battery_set_batch_cb(1000, battery_batch_cb, NULL);
+    device_battery_unset_batch_cb();
+    dts_check_eq(API_NAME_DEVICE_BATTERY_SET_BATCH_CB, error, DEVICE_ERROR_NONE);
+}
+
+static void utc_system_device_battery_set_batch_cb_n(void)
+{
+    int error = device_battery_set_batch_cb(0, battery_batch_cb, NULL);
+    dts_check_ne(API_NAME_DEVICE_BATTERY_SET_BATCH_CB, error, DEVICE_ERROR_NONE);
+}
+
+static void battery_warn_cb(device_battery_warn_e status, void *user_data)
+{
+}
+
+static void utc_system_device_battery_warning_set_level_cb_p(void)
+{
+    unsigned int levels = DEVICE_BATTERY_WARN_MASK(DEVICE_BATTERY_WARN_CRITICAL) |
+            DEVICE_BATTERY_WARN_MASK(DEVICE_BATTERY_WARN_EMPTY);
+    int error = device_battery_warning_set_level_cb(levels, battery_warn_cb, NULL);
+    device_battery_warning_unset_cb();
+    dts_check_eq(API_NAME_DEVICE_BATTERY_WARNING_SET_LEVEL_CB, error, DEVICE_ERROR_NONE);
+}
+
+static void utc_system_device_battery_warning_set_level_cb_n(void)
+{
+    int error = device_battery_warning_set_level_cb(0, battery_warn_cb, NULL);
+    dts_check_ne(API_NAME_DEVICE_BATTERY_WARNING_SET_LEVEL_CB, error, DEVICE_ERROR_NONE);
+}
+
+static void battery_detail_cb(int detail, void *user_data)
+{
+}
+
+static void utc_system_device_battery_set_detail_cb_p(void)
+{
+    int error = device_battery_set_detail_cb(10, battery_detail_cb, NULL);
+    device_battery_unset_detail_cb();
+    dts_check_eq(API_NAME_DEVICE_BATTERY_SET_DETAIL_CB, error, DEVICE_ERROR_NONE);
+}
+
+static void utc_system_device_battery_set_detail_cb_n(void)
+{
+    int error = device_battery_set_detail_cb(0, battery_detail_cb, NULL);
+    dts_check_ne(API_NAME_DEVICE_BATTERY_SET_DETAIL_CB, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_query()
+ */
+static void utc_system_device_query_p(void)
+{
+    device_prop_e keys[] = {
+        DEVICE_PROP_BATTERY_PERCENT,
+        DEVICE_PROP_BATTERY_CHARGING,
+        DEVICE_PROP_BATTERY_PERCENT,
+    };
+    device_value_s values[3];
+    int error = device_query(keys, 3, values);
+
+    if(error != DEVICE_ERROR_NONE || values[0].error != DEVICE_ERROR_NONE || values[1].error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_QUERY);
+    }
+
+    if(values[0].value != values[2].value || values[0].value < 0 || values[0].value > 100) {
+        dts_fail(API_NAME_DEVICE_QUERY);
+    }
+    dts_pass(API_NAME_DEVICE_QUERY);
+}
+
+/**
+ * @brief Negative test case of device_query() with bad key
+ */
+static void utc_system_device_query_n(void)
+{
+    device_prop_e keys[] = { DEVICE_PROP_MAX };
+    device_value_s values[1];
+    int error = device_query(keys, 1, values);
+
+    dts_check_ne(API_NAME_DEVICE_QUERY, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_changes_since()
+ */
+static void utc_system_device_changes_since_p(void)
+{
+    device_value_s values[DEVICE_PROP_MAX];
+    unsigned int generation = 0;
+    int count = 0;
+    int error = device_changes_since(0, &generation, values, DEVICE_PROP_MAX, &count);
+
+    if(error != DEVICE_ERROR_NONE || count <= 0) {
+        dts_fail(API_NAME_DEVICE_CHANGES_SINCE);
+    }
+
+    /* nothing changed since the generation we just got */
+    error = device_changes_since(generation, &generation, values, DEVICE_PROP_MAX, &count);
+    if(error != DEVICE_ERROR_NONE || count != 0) {
+        dts_fail(API_NAME_DEVICE_CHANGES_SINCE);
+    }
+    dts_pass(API_NAME_DEVICE_CHANGES_SINCE);
+}
+
+/**
+ * @brief Negative test case of device_changes_since() with null pointer
+ */
+static void utc_system_device_changes_since_n(void)
+{
+    unsigned int generation = 0;
+    int count = 0;
+    int error = device_changes_since(0, &generation, NULL, DEVICE_PROP_MAX, &count);
+
+    dts_check_ne(API_NAME_DEVICE_CHANGES_SINCE, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_callback_get_stats()
+ */
+static void utc_system_device_callback_get_stats_p(void)
+{
+    device_callback_stats_s stats;
+    int error;
+
+    device_callback_reset_stats(DEVICE_CALLBACK_BATTERY);
+    error = device_callback_get_stats(DEVICE_CALLBACK_BATTERY, &stats);
+    if(error != DEVICE_ERROR_NONE || stats.delivered != 0) {
+        dts_fail(API_NAME_DEVICE_CALLBACK_GET_STATS);
+    }
+    dts_pass(API_NAME_DEVICE_CALLBACK_GET_STATS);
+}
+
+/**
+ * @brief Negative test case of device_callback_get_stats() with null pointer
+ */
+static void utc_system_device_callback_get_stats_n(void)
+{
+    int error = device_callback_get_stats(DEVICE_CALLBACK_BATTERY, NULL);
+
+    dts_check_ne(API_NAME_DEVICE_CALLBACK_GET_STATS, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_callback_set_executor()
+ */
+static void utc_system_device_callback_set_executor_p(void)
+{
+    int error = device_callback_set_executor(DEVICE_CALLBACK_BATTERY, DEVICE_EXECUTOR_THREAD, NULL, NULL);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_CALLBACK_SET_EXECUTOR);
+    }
+
+    error = device_callback_set_executor(DEVICE_CALLBACK_BATTERY, DEVICE_EXECUTOR_INLINE, NULL, NULL);
+    dts_check_eq(API_NAME_DEVICE_CALLBACK_SET_EXECUTOR, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of device_callback_set_executor() without dispatch function
+ */
+static void utc_system_device_callback_set_executor_n(void)
+{
+    int error = device_callback_set_executor(DEVICE_CALLBACK_BATTERY, DEVICE_EXECUTOR_DISPATCH, NULL, NULL);
+    dts_check_ne(API_NAME_DEVICE_CALLBACK_SET_EXECUTOR, error, DEVICE_ERROR_NONE);
+}
+
+static bool battery_history_cb(const device_battery_sample_s *sample, void *user_data)
+{
+    (*(int*)user_data)++;
+    return true;
+}
+
+/**
+ * @brief Positive test case of device_battery_history_foreach()
+ */
+static void utc_system_device_battery_history_foreach_p(void)
+{
+    int count = 0;
+    int error;
+
+    unlink(HISTORY_PATH);
+    error = device_battery_history_start(HISTORY_PATH);
+    device_battery_history_stop();
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_BATTERY_HISTORY_FOREACH);
+    }
+
+    /* Every recording starts with a sample of the current state */
+    error = device_battery_history_foreach(HISTORY_PATH, 0, ~0ULL, battery_history_cb, &count);
+    unlink(HISTORY_PATH);
+    if(error != DEVICE_ERROR_NONE || count != 1) {
+        dts_fail(API_NAME_DEVICE_BATTERY_HISTORY_FOREACH);
+    }
+    dts_pass(API_NAME_DEVICE_BATTERY_HISTORY_FOREACH);
+}
+
+/**
+ * @brief Negative test case of device_battery_history_foreach() with null callback
+ */
+static void utc_system_device_battery_history_foreach_n(void)
+{
+    int error = device_battery_history_foreach(HISTORY_PATH, 0, ~0ULL, NULL, NULL);
+    dts_check_ne(API_NAME_DEVICE_BATTERY_HISTORY_FOREACH, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_battery_series_aggregate()
+ */
+static void utc_system_device_battery_series_aggregate_p(void)
+{
+    device_battery_series_h series = NULL;
+    device_battery_aggregate_s result;
+    int error;
+
+    unlink(HISTORY_PATH);
+    device_battery_history_start(HISTORY_PATH);
+    device_battery_history_stop();
+
+    error = device_battery_series_create(HISTORY_PATH, 0, ~0ULL, &series);
+    unlink(HISTORY_PATH);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_BATTERY_SERIES_AGGREGATE);
+    }
+
+    error = device_battery_series_aggregate(series, DEVICE_BATTERY_SERIES_PERCENT, 0, 1, &result);
+    device_battery_series_destroy(series);
+    if(error != DEVICE_ERROR_NONE || result.count != 1 || result.min != result.max) {
+        dts_fail(API_NAME_DEVICE_BATTERY_SERIES_AGGREGATE);
+    }
+    dts_pass(API_NAME_DEVICE_BATTERY_SERIES_AGGREGATE);
+}
+
+/**
+ * @brief Negative test case of device_battery_series_aggregate() with null series
+ */
+static void utc_system_device_battery_series_aggregate_n(void)
+{
+    device_battery_aggregate_s result;
+    int error = device_battery_series_aggregate(NULL, DEVICE_BATTERY_SERIES_PERCENT, 0, 1, &result);
+    dts_check_ne(API_NAME_DEVICE_BATTERY_SERIES_AGGREGATE, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_battery_series_get_index() on a history whose clock was set back
+ */
+static void utc_system_device_battery_series_get_index_p(void)
+{
+    /* Keyframes of times 10, 30, then 20 after the clock was set back, and 40, percent equal to the time */
+    static const unsigned char records[] = {
+        0x01, 10, 10 << 1, 0,
+        0x01, 30, 30 << 1, 0,
+        0x01, 20, 20 << 1, 0,
+        0x01, 40, 40 << 1, 0,
+    };
+    static const unsigned int version[2] = { 1, 0 };
+    device_battery_series_h series = NULL;
+    device_battery_aggregate_s result;
+    FILE *fp;
+    int index = -1;
+    int error;
+
+    fp = fopen(HISTORY_PATH, "w");
+    if(fp == NULL) {
+        dts_fail(API_NAME_DEVICE_BATTERY_SERIES_GET_INDEX);
+    }
+    fwrite("DEVHIST", 8, 1, fp);
+    fwrite(version, sizeof(version), 1, fp);
+    fwrite(records, sizeof(records), 1, fp);
+    fclose(fp);
+
+    error = device_battery_series_create(HISTORY_PATH, 0, ~0ULL, &series);
+    unlink(HISTORY_PATH);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_BATTERY_SERIES_GET_INDEX);
+    }
+
+    /* Sorted by time the samples are 10, 20, 30, 40 */
+    error = device_battery_series_get_index(series, 30, &index);
+    if(error == DEVICE_ERROR_NONE) {
+        error = device_battery_series_aggregate(series, DEVICE_BATTERY_SERIES_PERCENT, 0, 2, &result);
+    }
+    device_battery_series_destroy(series);
+    if(error != DEVICE_ERROR_NONE || index != 2 || result.min != 10 || result.max != 20) {
+        dts_fail(API_NAME_DEVICE_BATTERY_SERIES_GET_INDEX);
+    }
+    dts_pass(API_NAME_DEVICE_BATTERY_SERIES_GET_INDEX);
+}
+
+static void wait_cb(int error, int value, void *user_data)
+{
+}
+
+/**
+ * @brief Positive test case of device_wait_once(), a pending wait can be canceled once
+ */
+static void utc_system_device_wait_once_p(void)
+{
+    device_waiter_s waiter = { 0, };
+    int error;
+
+    error = device_wait_once(DEVICE_WAIT_BATTERY_CAPACITY, &waiter, wait_cb, NULL);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_WAIT_ONCE);
+    }
+
+    error = device_wait_cancel(&waiter);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_WAIT_ONCE);
+    }
+    dts_check_ne(API_NAME_DEVICE_WAIT_ONCE, device_wait_cancel(&waiter), DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of device_wait_once() with invalid event
+ */
+static void utc_system_device_wait_once_n(void)
+{
+    device_waiter_s waiter = { 0, };
+    int error = device_wait_once(DEVICE_WAIT_MAX, &waiter, wait_cb, NULL);
+    dts_check_ne(API_NAME_DEVICE_WAIT_ONCE, error, DEVICE_ERROR_NONE);
+}
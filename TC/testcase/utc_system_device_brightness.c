@@ -16,6 +16,7 @@
  * 
  */
 #include <tet_api.h>
+#include <unistd.h>
 #include <device.h>
 #include <power.h>
 
@@ -24,6 +25,15 @@
 #define API_NAME_DEVICE_GET_MAX_BRIGHTNESS "device_get_max_brightness"
 #define API_NAME_DEVICE_SET_BRIGHTNESS "device_set_brightness"
 #define API_NAME_DEVICE_SET_BRIGHTNESS_FROM_SETTINGS "device_set_brightness_from_settings"
+#define API_NAME_DEVICE_GET_BRIGHTNESS_ASYNC "device_get_brightness_async"
+#define API_NAME_DEVICE_SET_BRIGHTNESS_PERCENT "device_set_brightness_percent"
+#define API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE "device_brightness_lease_acquire"
+#define API_NAME_DEVICE_BRIGHTNESS_LEASE_RELEASE "device_brightness_lease_release"
+#define API_NAME_DEVICE_SCENE_APPLY "device_scene_apply"
+#define API_NAME_DEVICE_SET_TIMEOUT "device_set_timeout"
+#define API_NAME_DEVICE_SET_RETRY_POLICY "device_set_retry_policy"
+#define API_NAME_DEVICE_SUBSYSTEM_GET_STATS "device_subsystem_get_stats"
+#define API_NAME_DEVICE_SET_BRIGHTNESS_UNCHECKED "device_set_brightness_unchecked"
 
 static void startup(void);
 static void cleanup(void);
@@ -45,6 +55,23 @@ static void utc_system_device_set_brightness_n_1(void);
 static void utc_system_device_set_brightness_n_2(void);
 static void utc_system_device_set_brightness_from_settings_p(void);
 static void utc_system_device_set_brightness_from_settings_n(void);
+static void utc_system_device_get_brightness_async_p(void);
+static void utc_system_device_get_brightness_async_n(void);
+static void utc_system_device_set_brightness_percent_p(void);
+static void utc_system_device_set_brightness_percent_n(void);
+static void utc_system_device_brightness_lease_acquire_p(void);
+static void utc_system_device_brightness_lease_acquire_n(void);
+static void utc_system_device_brightness_lease_release_p(void);
+static void utc_system_device_scene_apply_p(void);
+static void utc_system_device_scene_apply_n(void);
+static void utc_system_device_set_timeout_p(void);
+static void utc_system_device_set_timeout_n(void);
+static void utc_system_device_set_retry_policy_p(void);
+static void utc_system_device_set_retry_policy_n(void);
+static void utc_system_device_subsystem_get_stats_p(void);
+static void utc_system_device_subsystem_get_stats_n(void);
+static void utc_system_device_set_brightness_unchecked_p(void);
+static void utc_system_device_set_brightness_unchecked_n(void);
 
 
 enum {
@@ -66,6 +93,23 @@ struct tet_testlist tet_testlist[] = {
 	{ utc_system_device_set_brightness_n_2, NEGATIVE_TC_IDX },
 	{ utc_system_device_set_brightness_from_settings_p, POSITIVE_TC_IDX },
 	{ utc_system_device_set_brightness_from_settings_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_get_brightness_async_p, POSITIVE_TC_IDX },
+	{ utc_system_device_get_brightness_async_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_set_brightness_percent_p, POSITIVE_TC_IDX },
+	{ utc_system_device_set_brightness_percent_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_brightness_lease_acquire_p, POSITIVE_TC_IDX },
+	{ utc_system_device_brightness_lease_acquire_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_brightness_lease_release_p, POSITIVE_TC_IDX },
+	{ utc_system_device_scene_apply_p, POSITIVE_TC_IDX },
+	{ utc_system_device_scene_apply_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_set_timeout_p, POSITIVE_TC_IDX },
+	{ utc_system_device_set_timeout_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_set_retry_policy_p, POSITIVE_TC_IDX },
+	{ utc_system_device_set_retry_policy_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_subsystem_get_stats_p, POSITIVE_TC_IDX },
+	{ utc_system_device_subsystem_get_stats_n, NEGATIVE_TC_IDX },
+	{ utc_system_device_set_brightness_unchecked_p, POSITIVE_TC_IDX },
+	{ utc_system_device_set_brightness_unchecked_n, NEGATIVE_TC_IDX },
 	{ NULL, 0},
 };
 
@@ -328,3 +372,333 @@ static void utc_system_device_set_brightness_from_settings_n(void)
 
 	dts_check_ne(API_NAME_DEVICE_SET_BRIGHTNESS_FROM_SETTINGS, error, DEVICE_ERROR_NONE);
 }
+
+static volatile int async_done;
+static volatile int async_error;
+
+static void async_cb(int request_id, int error, int value, void *user_data)
+{
+    async_error = error;
+    async_done = 1;
+}
+
+/**
+ * @brief Positive test case of device_get_brightness_async()
+ */
+static void utc_system_device_get_brightness_async_p(void)
+{
+    int error, id, wait;
+
+    async_done = 0;
+    error = device_get_brightness_async(0, async_cb, NULL, &id);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_GET_BRIGHTNESS_ASYNC);
+    }
+
+    for(wait=0; wait<100 && !async_done; wait++)
+        usleep(10000);
+
+    if(!async_done || async_error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_GET_BRIGHTNESS_ASYNC);
+    }
+    dts_pass(API_NAME_DEVICE_GET_BRIGHTNESS_ASYNC);
+}
+
+/**
+ * @brief Negative test case of device_get_brightness_async() with null callback
+ */
+static void utc_system_device_get_brightness_async_n(void)
+{
+    int error = DEVICE_ERROR_NONE;
+
+    error = device_get_brightness_async(0, NULL, NULL, NULL);
+    dts_check_ne(API_NAME_DEVICE_GET_BRIGHTNESS_ASYNC, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_set_brightness_percent()
+ */
+static void utc_system_device_set_brightness_percent_p(void)
+{
+    int error, percent;
+
+    error = device_set_brightness_curve(0, DEVICE_BRIGHTNESS_CURVE_LIGHTNESS);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_BRIGHTNESS_PERCENT);
+    }
+
+    error = device_set_brightness_percent(0, 100);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_BRIGHTNESS_PERCENT);
+    }
+
+    error = device_get_brightness_percent(0, &percent);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_BRIGHTNESS_PERCENT);
+    }
+    dts_check_eq(API_NAME_DEVICE_SET_BRIGHTNESS_PERCENT, percent, 100);
+}
+
+/**
+ * @brief Negative test case of device_set_brightness_percent() with out of range percentage
+ */
+static void utc_system_device_set_brightness_percent_n(void)
+{
+    int error = DEVICE_ERROR_NONE;
+
+    error = device_set_brightness_percent(0, 101);
+    dts_check_ne(API_NAME_DEVICE_SET_BRIGHTNESS_PERCENT, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_brightness_lease_acquire(), the higher priority lease wins
+ */
+static void utc_system_device_brightness_lease_acquire_p(void)
+{
+    device_brightness_lease_h low, high;
+    int error, value;
+
+    error = device_brightness_lease_acquire(0, 1, 0, &low);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE);
+    }
+
+    error = device_brightness_lease_acquire(0, 2, 1, &high);
+    if(error != DEVICE_ERROR_NONE) {
+        device_brightness_lease_release(low);
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE);
+    }
+
+    device_brightness_lease_update(low, 0);
+    error = device_get_brightness(0, &value);
+
+    device_brightness_lease_release(high);
+    device_brightness_lease_release(low);
+
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE);
+    }
+    dts_check_eq(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE, value, 1);
+}
+
+/**
+ * @brief Negative test case of device_brightness_lease_acquire() with invalid display index
+ */
+static void utc_system_device_brightness_lease_acquire_n(void)
+{
+    device_brightness_lease_h lease;
+    int error = DEVICE_ERROR_NONE;
+
+    error = device_brightness_lease_acquire(cnt+1, 1, 0, &lease);
+    dts_check_ne(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_brightness_lease_release(), the next lease is written again after a direct set
+ */
+static void utc_system_device_brightness_lease_release_p(void)
+{
+    device_brightness_lease_h low, high;
+    int error, value;
+
+    error = device_brightness_lease_acquire(0, 2, 1, &high);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_RELEASE);
+    }
+
+    error = device_brightness_lease_acquire(0, 1, 1, &low);
+    if(error != DEVICE_ERROR_NONE) {
+        device_brightness_lease_release(high);
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_RELEASE);
+    }
+
+    device_set_brightness(0, 0);
+    device_brightness_lease_release(high);
+    error = device_get_brightness(0, &value);
+
+    device_brightness_lease_release(low);
+
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_RELEASE);
+    }
+    dts_check_eq(API_NAME_DEVICE_BRIGHTNESS_LEASE_RELEASE, value, 1);
+}
+
+/**
+ * @brief Positive test case of device_scene_apply()
+ */
+static void utc_system_device_scene_apply_p(void)
+{
+    device_scene_s scene = { { DEVICE_SCENE_UNCHANGED, DEVICE_SCENE_UNCHANGED }, DEVICE_SCENE_UNCHANGED };
+    int error, max, value;
+
+    error = device_get_max_brightness(0, &max);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SCENE_APPLY);
+    }
+
+    scene.display_brightness[0] = max;
+    error = device_scene_apply(&scene);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SCENE_APPLY);
+    }
+
+    error = device_get_brightness(0, &value);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SCENE_APPLY);
+    }
+    dts_check_eq(API_NAME_DEVICE_SCENE_APPLY, value, max);
+}
+
+/**
+ * @brief Negative test case of device_scene_apply() with out of range flash brightness, nothing is written
+ */
+static void utc_system_device_scene_apply_n(void)
+{
+    device_scene_s scene = { { 0, DEVICE_SCENE_UNCHANGED }, DEVICE_SCENE_UNCHANGED };
+    int error, max, before, after;
+
+    device_get_brightness(0, &before);
+    device_flash_get_max_brightness(&max);
+    scene.flash_brightness = max + 1;
+
+    error = device_scene_apply(&scene);
+    if(error == DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SCENE_APPLY);
+    }
+
+    device_get_brightness(0, &after);
+    dts_check_eq(API_NAME_DEVICE_SCENE_APPLY, after, before);
+}
+
+/**
+ * @brief Positive test case of device_set_timeout(), calls of a responsive device complete within the deadline
+ */
+static void utc_system_device_set_timeout_p(void)
+{
+    int error, value;
+
+    error = device_set_timeout(1000);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_TIMEOUT);
+    }
+
+    error = device_get_brightness(0, &value);
+    device_set_timeout(0);
+    dts_check_eq(API_NAME_DEVICE_SET_TIMEOUT, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Negative test case of device_set_timeout() with negative timeout
+ */
+static void utc_system_device_set_timeout_n(void)
+{
+    int error = DEVICE_ERROR_NONE;
+
+    error = device_set_timeout(-1);
+    dts_check_eq(API_NAME_DEVICE_SET_TIMEOUT, error, DEVICE_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of device_set_retry_policy()
+ */
+static void utc_system_device_set_retry_policy_p(void)
+{
+    device_retry_policy_s policy, saved;
+    int error;
+
+    error = device_get_retry_policy(&saved);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_RETRY_POLICY);
+    }
+
+    policy = saved;
+    policy.attempts = 1;
+    error = device_set_retry_policy(&policy);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_RETRY_POLICY);
+    }
+
+    device_get_retry_policy(&policy);
+    device_set_retry_policy(&saved);
+    dts_check_eq(API_NAME_DEVICE_SET_RETRY_POLICY, policy.attempts, 1);
+}
+
+/**
+ * @brief Negative test case of device_set_retry_policy() with no attempt
+ */
+static void utc_system_device_set_retry_policy_n(void)
+{
+    device_retry_policy_s policy;
+    int error = DEVICE_ERROR_NONE;
+
+    device_get_retry_policy(&policy);
+    policy.attempts = 0;
+    error = device_set_retry_policy(&policy);
+    dts_check_eq(API_NAME_DEVICE_SET_RETRY_POLICY, error, DEVICE_ERROR_INVALID_PARAMETER);
+}
+
+/**
+ * @brief Positive test case of device_subsystem_get_stats(), a successful call is counted
+ */
+static void utc_system_device_subsystem_get_stats_p(void)
+{
+    device_subsystem_stats_s stats;
+    int error, value;
+
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_DISPLAY);
+    device_get_brightness(0, &value);
+
+    error = device_subsystem_get_stats(DEVICE_SUBSYSTEM_DISPLAY, &stats);
+    if(error != DEVICE_ERROR_NONE || stats.calls == 0) {
+        dts_fail(API_NAME_DEVICE_SUBSYSTEM_GET_STATS);
+    }
+    dts_check_eq(API_NAME_DEVICE_SUBSYSTEM_GET_STATS, stats.breaker, DEVICE_BREAKER_CLOSED);
+}
+
+/**
+ * @brief Negative test case of device_subsystem_get_stats() with invalid subsystem
+ */
+static void utc_system_device_subsystem_get_stats_n(void)
+{
+    device_subsystem_stats_s stats;
+    int error = DEVICE_ERROR_NONE;
+
+    error = device_subsystem_get_stats(DEVICE_SUBSYSTEM_MAX, &stats);
+    dts_check_ne(API_NAME_DEVICE_SUBSYSTEM_GET_STATS, error, DEVICE_ERROR_NONE);
+}
+
+/**
+ * @brief Positive test case of device_set_brightness_unchecked(), the value reads back unchecked
+ */
+static void utc_system_device_set_brightness_unchecked_p(void)
+{
+    int error, max, value;
+
+    error = device_get_max_brightness(0, &max);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_BRIGHTNESS_UNCHECKED);
+    }
+
+    error = device_set_brightness_unchecked(0, max);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_BRIGHTNESS_UNCHECKED);
+    }
+
+    error = device_get_brightness_unchecked(0, &value);
+    if(error != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_BRIGHTNESS_UNCHECKED);
+    }
+    dts_check_eq(API_NAME_DEVICE_SET_BRIGHTNESS_UNCHECKED, value, max);
+}
+
+/**
+ * @brief Negative test case of device_set_brightness_unchecked() with an index no platform can address
+ */
+static void utc_system_device_set_brightness_unchecked_n(void)
+{
+    int error = DEVICE_ERROR_NONE;
+
+    error = device_set_brightness_unchecked(DEVICE_SCENE_DISPLAY_MAX, 0);
+    dts_check_eq(API_NAME_DEVICE_SET_BRIGHTNESS_UNCHECKED, error, DEVICE_ERROR_INVALID_PARAMETER);
+}
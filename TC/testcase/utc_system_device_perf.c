@@ -0,0 +1,373 @@
+/*
+ *
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ *
+ * This software is the confidential and proprietary information of SAMSUNG
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that
+ * this software is owned by Samsung and you shall not disclose such
+ * Confidential Information and shall use it only in accordance with the terms
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG
+ * make no representations or warranties about the suitability of the software,
+ * either express or implied, including but not limited to the implied
+ * warranties of merchantability, fitness for a particular purpose, or
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by
+ * licensee arising out of or related to this software.
+ *
+ */
+
+/*
+ * Performance budgets, checked against the mock backend so that only the
+ * library is measured: the mean latency of a call, the backend calls an
+ * API makes (see device_subsystem_get_stats()) and the heap allocations
+ * it makes once warmed up. A change that adds a devman round trip or an
+ * allocation to one of these paths fails here.
+ */
+
+#include <tet_api.h>
+#include <stdlib.h>
+#include <time.h>
+#include <device.h>
+
+#define API_NAME_DEVICE_GET_BRIGHTNESS "device_get_brightness"
+#define API_NAME_DEVICE_SET_BRIGHTNESS "device_set_brightness"
+#define API_NAME_DEVICE_BATTERY_GET_PERCENT "device_battery_get_percent"
+#define API_NAME_DEVICE_SCENE_APPLY "device_scene_apply"
+#define API_NAME_DEVICE_BRIGHTNESS_LEASE_UPDATE "device_brightness_lease_update"
+#define API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE "device_brightness_lease_acquire"
+#define API_NAME_DEVICE_QUERY "device_query"
+
+/* Calls timed per case, and the mean latency they must stay under */
+#define PERF_CALLS 10000
+#define PERF_BUDGET_NS 20000
+
+static void startup(void);
+static void cleanup(void);
+
+void (*tet_startup)(void) = startup;
+void (*tet_cleanup)(void) = cleanup;
+
+static void utc_system_device_perf_get_brightness_latency_p(void);
+static void utc_system_device_perf_set_brightness_latency_p(void);
+static void utc_system_device_perf_battery_get_percent_latency_p(void);
+static void utc_system_device_perf_get_brightness_backend_calls_p(void);
+static void utc_system_device_perf_set_brightness_backend_calls_p(void);
+static void utc_system_device_perf_battery_get_percent_backend_calls_p(void);
+static void utc_system_device_perf_scene_apply_backend_calls_p(void);
+static void utc_system_device_perf_lease_update_backend_calls_p(void);
+static void utc_system_device_perf_query_backend_calls_p(void);
+static void utc_system_device_perf_allocations_p(void);
+static void utc_system_device_perf_lease_allocations_p(void);
+
+
+enum {
+	POSITIVE_TC_IDX = 0x01,
+	NEGATIVE_TC_IDX,
+};
+
+struct tet_testlist tet_testlist[] = {
+	{ utc_system_device_perf_get_brightness_latency_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_set_brightness_latency_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_battery_get_percent_latency_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_get_brightness_backend_calls_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_set_brightness_backend_calls_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_battery_get_percent_backend_calls_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_scene_apply_backend_calls_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_lease_update_backend_calls_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_query_backend_calls_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_allocations_p, POSITIVE_TC_IDX },
+	{ utc_system_device_perf_lease_allocations_p, POSITIVE_TC_IDX },
+	{ NULL, 0},
+};
+
+/*
+ * Heap allocations of the process, counted by interposing the allocator.
+ * The library resolves malloc() to these, they forward to glibc.
+ */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static unsigned long allocs;
+
+void *malloc(size_t size)
+{
+    __atomic_add_fetch(&allocs, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    __atomic_add_fetch(&allocs, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    __atomic_add_fetch(&allocs, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+static unsigned long alloc_count(void)
+{
+    return __atomic_load_n(&allocs, __ATOMIC_RELAXED);
+}
+
+/* Backend calls made by device_get_display_numbers(), 0 in a single display build */
+static unsigned long long count_calls;
+
+static unsigned long long backend_calls(device_subsystem_e subsystem)
+{
+    device_subsystem_stats_s stats;
+
+    if(device_subsystem_get_stats(subsystem, &stats) != DEVICE_ERROR_NONE)
+        return ~0ULL;
+    return stats.calls;
+}
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int max_brightness;
+
+static void startup(void)
+{
+	/* start of TC */
+    int value;
+
+    /* The backend is selected by the first call of the process */
+    setenv("CAPI_SYSTEM_DEVICE_BACKEND", "mock", 1);
+    unsetenv("CAPI_SYSTEM_DEVICE_MOCK");
+
+    /* Warm up the backend selection and the cached limits */
+    device_get_max_brightness(0, &max_brightness);
+    device_set_brightness(0, max_brightness);
+    device_get_brightness(0, &value);
+    device_battery_get_percent(&value);
+
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_DISPLAY);
+    device_get_display_numbers(&value);
+    count_calls = backend_calls(DEVICE_SUBSYSTEM_DISPLAY);
+}
+
+static void cleanup(void)
+{
+	/* end of TC */
+}
+
+/**
+ * @brief Mean latency of device_get_brightness() within the budget
+ */
+static void utc_system_device_perf_get_brightness_latency_p(void)
+{
+    unsigned long long start, elapsed;
+    int i, value;
+
+    start = now_ns();
+    for(i = 0; i < PERF_CALLS; i++) {
+        if(device_get_brightness(0, &value) != DEVICE_ERROR_NONE) {
+            dts_fail(API_NAME_DEVICE_GET_BRIGHTNESS);
+        }
+    }
+    elapsed = now_ns() - start;
+
+    dts_check_eq(API_NAME_DEVICE_GET_BRIGHTNESS, elapsed / PERF_CALLS < PERF_BUDGET_NS, 1);
+}
+
+/**
+ * @brief Mean latency of device_set_brightness() within the budget
+ */
+static void utc_system_device_perf_set_brightness_latency_p(void)
+{
+    unsigned long long start, elapsed;
+    int i;
+
+    start = now_ns();
+    for(i = 0; i < PERF_CALLS; i++) {
+        if(device_set_brightness(0, i % (max_brightness + 1)) != DEVICE_ERROR_NONE) {
+            dts_fail(API_NAME_DEVICE_SET_BRIGHTNESS);
+        }
+    }
+    elapsed = now_ns() - start;
+
+    dts_check_eq(API_NAME_DEVICE_SET_BRIGHTNESS, elapsed / PERF_CALLS < PERF_BUDGET_NS, 1);
+}
+
+/**
+ * @brief Mean latency of device_battery_get_percent() within the budget
+ */
+static void utc_system_device_perf_battery_get_percent_latency_p(void)
+{
+    unsigned long long start, elapsed;
+    int i, value;
+
+    start = now_ns();
+    for(i = 0; i < PERF_CALLS; i++) {
+        if(device_battery_get_percent(&value) != DEVICE_ERROR_NONE) {
+            dts_fail(API_NAME_DEVICE_BATTERY_GET_PERCENT);
+        }
+    }
+    elapsed = now_ns() - start;
+
+    dts_check_eq(API_NAME_DEVICE_BATTERY_GET_PERCENT, elapsed / PERF_CALLS < PERF_BUDGET_NS, 1);
+}
+
+/**
+ * @brief device_get_brightness() makes one backend read besides the display count
+ */
+static void utc_system_device_perf_get_brightness_backend_calls_p(void)
+{
+    int value;
+
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_DISPLAY);
+    if(device_get_brightness(0, &value) != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_GET_BRIGHTNESS);
+    }
+    dts_check_eq(API_NAME_DEVICE_GET_BRIGHTNESS, backend_calls(DEVICE_SUBSYSTEM_DISPLAY), count_calls + 1);
+}
+
+/**
+ * @brief device_set_brightness() makes one backend write besides the display count, the maximum is cached
+ */
+static void utc_system_device_perf_set_brightness_backend_calls_p(void)
+{
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_DISPLAY);
+    if(device_set_brightness(0, max_brightness) != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SET_BRIGHTNESS);
+    }
+    dts_check_eq(API_NAME_DEVICE_SET_BRIGHTNESS, backend_calls(DEVICE_SUBSYSTEM_DISPLAY), count_calls + 1);
+}
+
+/**
+ * @brief device_battery_get_percent() makes one backend call
+ */
+static void utc_system_device_perf_battery_get_percent_backend_calls_p(void)
+{
+    int value;
+
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_BATTERY);
+    if(device_battery_get_percent(&value) != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_BATTERY_GET_PERCENT);
+    }
+    dts_check_eq(API_NAME_DEVICE_BATTERY_GET_PERCENT, backend_calls(DEVICE_SUBSYSTEM_BATTERY), 1);
+}
+
+/**
+ * @brief device_scene_apply() reads each target once and skips the writes that change nothing
+ */
+static void utc_system_device_perf_scene_apply_backend_calls_p(void)
+{
+    device_scene_s scene = { { DEVICE_SCENE_UNCHANGED, DEVICE_SCENE_UNCHANGED }, DEVICE_SCENE_UNCHANGED };
+
+    device_set_brightness(0, 0);
+    scene.display_brightness[0] = max_brightness;
+
+    /* a read and a write */
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_DISPLAY);
+    if(device_scene_apply(&scene) != DEVICE_ERROR_NONE || backend_calls(DEVICE_SUBSYSTEM_DISPLAY) != 2) {
+        dts_fail(API_NAME_DEVICE_SCENE_APPLY);
+    }
+
+    /* the same scene again only reads */
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_DISPLAY);
+    if(device_scene_apply(&scene) != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_SCENE_APPLY);
+    }
+    dts_check_eq(API_NAME_DEVICE_SCENE_APPLY, backend_calls(DEVICE_SUBSYSTEM_DISPLAY), 1);
+}
+
+/**
+ * @brief Updating a lease that does not win writes nothing
+ */
+static void utc_system_device_perf_lease_update_backend_calls_p(void)
+{
+    device_brightness_lease_h high = NULL, low = NULL;
+    unsigned long long calls;
+
+    if(device_brightness_lease_acquire(0, 10, max_brightness, &high) != DEVICE_ERROR_NONE ||
+            device_brightness_lease_acquire(0, 1, 0, &low) != DEVICE_ERROR_NONE) {
+        device_brightness_lease_release(high);
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_UPDATE);
+    }
+
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_DISPLAY);
+    device_brightness_lease_update(low, 1);
+    calls = backend_calls(DEVICE_SUBSYSTEM_DISPLAY);
+
+    device_brightness_lease_release(low);
+    device_brightness_lease_release(high);
+
+    /* only the value check, which reads no limit once it is cached */
+    dts_check_eq(API_NAME_DEVICE_BRIGHTNESS_LEASE_UPDATE, calls, 0);
+}
+
+/**
+ * @brief device_query() reads the display count once for all display properties
+ */
+static void utc_system_device_perf_query_backend_calls_p(void)
+{
+    device_prop_e keys[] = { DEVICE_PROP_DISPLAY_COUNT, DEVICE_PROP_DISPLAY0_BRIGHTNESS, DEVICE_PROP_BATTERY_PERCENT };
+    device_value_s values[3];
+
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_DISPLAY);
+    device_subsystem_reset_stats(DEVICE_SUBSYSTEM_BATTERY);
+    if(device_query(keys, 3, values) != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_QUERY);
+    }
+
+    if(backend_calls(DEVICE_SUBSYSTEM_BATTERY) != 1) {
+        dts_fail(API_NAME_DEVICE_QUERY);
+    }
+    dts_check_eq(API_NAME_DEVICE_QUERY, backend_calls(DEVICE_SUBSYSTEM_DISPLAY), count_calls + 1);
+}
+
+/**
+ * @brief The synchronous calls allocate nothing once warmed up
+ */
+static void utc_system_device_perf_allocations_p(void)
+{
+    device_prop_e keys[] = { DEVICE_PROP_DISPLAY0_BRIGHTNESS, DEVICE_PROP_BATTERY_PERCENT };
+    device_value_s values[2];
+    unsigned long before;
+    int i, value;
+
+    before = alloc_count();
+    for(i = 0; i < PERF_CALLS / 10; i++) {
+        device_get_brightness(0, &value);
+        device_set_brightness(0, max_brightness);
+        device_battery_get_percent(&value);
+        device_query(keys, 2, values);
+    }
+    dts_check_eq(API_NAME_DEVICE_GET_BRIGHTNESS, alloc_count() - before, 0);
+}
+
+/**
+ * @brief A lease costs one allocation when acquired and none when updated
+ */
+static void utc_system_device_perf_lease_allocations_p(void)
+{
+    device_brightness_lease_h lease = NULL;
+    unsigned long before, acquired;
+    int i;
+
+    before = alloc_count();
+    if(device_brightness_lease_acquire(0, 0, max_brightness, &lease) != DEVICE_ERROR_NONE) {
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE);
+    }
+    acquired = alloc_count() - before;
+
+    before = alloc_count();
+    for(i = 0; i < PERF_CALLS / 10; i++)
+        device_brightness_lease_update(lease, i % (max_brightness + 1));
+    device_brightness_lease_release(lease);
+
+    if(acquired != 1) {
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE);
+    }
+    dts_check_eq(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE, alloc_count() - before, 0);
+}
@@ -0,0 +1,128 @@
+/*
+ *
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ *
+ * This software is the confidential and proprietary information of SAMSUNG
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that
+ * this software is owned by Samsung and you shall not disclose such
+ * Confidential Information and shall use it only in accordance with the terms
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG
+ * make no representations or warranties about the suitability of the software,
+ * either express or implied, including but not limited to the implied
+ * warranties of merchantability, fitness for a particular purpose, or
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by
+ * licensee arising out of or related to this software.
+ *
+ */
+
+/*
+ * Call deadlines (see device_set_timeout()), checked against the mock
+ * backend with a latency on every backend call. The mock reads its options
+ * once, when the backend is selected, so these cases run in their own process.
+ */
+
+#include <tet_api.h>
+#include <stdlib.h>
+#include <time.h>
+#include <device.h>
+
+#define API_NAME_DEVICE_SET_BRIGHTNESS_PERCENT "device_set_brightness_percent"
+#define API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE "device_brightness_lease_acquire"
+
+/* Latency of each backend call, the deadline it exceeds, and the lateness allowed */
+#define MOCK_OPTIONS "latency=30000"
+#define TIMEOUT_MS 50
+#define SLACK_MS 20
+
+static void startup(void);
+static void cleanup(void);
+
+void (*tet_startup)(void) = startup;
+void (*tet_cleanup)(void) = cleanup;
+
+static void utc_system_device_timeout_set_brightness_percent_p(void);
+static void utc_system_device_timeout_lease_acquire_p(void);
+
+
+enum {
+	POSITIVE_TC_IDX = 0x01,
+	NEGATIVE_TC_IDX,
+};
+
+struct tet_testlist tet_testlist[] = {
+	{ utc_system_device_timeout_set_brightness_percent_p, POSITIVE_TC_IDX },
+	{ utc_system_device_timeout_lease_acquire_p, POSITIVE_TC_IDX },
+	{ NULL, 0},
+};
+
+static unsigned long long now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+static void startup(void)
+{
+	/* start of TC */
+
+    /* The backend is selected by the first call of the process */
+    setenv("CAPI_SYSTEM_DEVICE_BACKEND", "mock", 1);
+    setenv("CAPI_SYSTEM_DEVICE_MOCK", MOCK_OPTIONS, 1);
+}
+
+static void cleanup(void)
+{
+	/* end of TC */
+    device_set_timeout(0);
+}
+
+/**
+ * @brief device_set_brightness_percent() returns DEVICE_ERROR_TIMED_OUT within its deadline
+ */
+static void utc_system_device_timeout_set_brightness_percent_p(void)
+{
+    unsigned long long start, elapsed;
+    int error;
+
+    device_set_timeout(TIMEOUT_MS);
+
+    start = now_ms();
+    error = device_set_brightness_percent(0, 50);
+    elapsed = now_ms() - start;
+
+    device_set_timeout(0);
+
+    if(error != DEVICE_ERROR_TIMED_OUT) {
+        dts_fail(API_NAME_DEVICE_SET_BRIGHTNESS_PERCENT);
+    }
+    dts_check_eq(API_NAME_DEVICE_SET_BRIGHTNESS_PERCENT, elapsed <= TIMEOUT_MS + SLACK_MS, 1);
+}
+
+/**
+ * @brief device_brightness_lease_acquire() returns DEVICE_ERROR_TIMED_OUT within its deadline
+ */
+static void utc_system_device_timeout_lease_acquire_p(void)
+{
+    unsigned long long start, elapsed;
+    device_brightness_lease_h lease = NULL;
+    int error;
+
+    device_set_timeout(TIMEOUT_MS);
+
+    start = now_ms();
+    error = device_brightness_lease_acquire(0, 1, 50, &lease);
+    elapsed = now_ms() - start;
+
+    device_set_timeout(0);
+    if(error == DEVICE_ERROR_NONE) {
+        device_brightness_lease_release(lease);
+    }
+
+    if(error != DEVICE_ERROR_TIMED_OUT) {
+        dts_fail(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE);
+    }
+    dts_check_eq(API_NAME_DEVICE_BRIGHTNESS_LEASE_ACQUIRE, elapsed <= TIMEOUT_MS + SLACK_MS, 1);
+}
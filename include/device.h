@@ -42,6 +42,8 @@ typedef enum
     DEVICE_ERROR_INVALID_PARAMETER = TIZEN_ERROR_INVALID_PARAMETER,   /**< Invalid parameter */
     DEVICE_ERROR_OPERATION_FAILED  = TIZEN_ERROR_SYSTEM_CLASS | 0x12, /**< Operation failed */
     DEVICE_ERROR_NOT_SUPPORTED     = TIZEN_ERROR_SYSTEM_CLASS | 0x13, /**< Not supported in this device */
+    DEVICE_ERROR_RESOURCE_BUSY     = TIZEN_ERROR_RESOURCE_BUSY,       /**< Request queue is full */
+    DEVICE_ERROR_TIMED_OUT         = TIZEN_ERROR_TIMED_OUT,           /**< The deadline of the call passed */
 } device_error_e;
 
 /**
@@ -56,6 +58,106 @@ typedef enum
     DEVICE_BATTERY_WARN_FULL,      /**< The battery status is full. */
 } device_battery_warn_e;
 
+/**
+ * @brief The bit of a battery warning status in the level mask of device_battery_warning_set_level_cb()
+ */
+#define DEVICE_BATTERY_WARN_MASK(status) (1u << (status))
+
+/**
+ * @brief The level mask with every battery warning status
+ */
+#define DEVICE_BATTERY_WARN_MASK_ALL \
+    (DEVICE_BATTERY_WARN_MASK(DEVICE_BATTERY_WARN_EMPTY) | DEVICE_BATTERY_WARN_MASK(DEVICE_BATTERY_WARN_CRITICAL) | \
+     DEVICE_BATTERY_WARN_MASK(DEVICE_BATTERY_WARN_LOW) | DEVICE_BATTERY_WARN_MASK(DEVICE_BATTERY_WARN_NORMAL) | \
+     DEVICE_BATTERY_WARN_MASK(DEVICE_BATTERY_WARN_FULL))
+
+/**
+ * @brief Enumerations of the device properties that can be read with device_query()
+ */
+typedef enum
+{
+    DEVICE_PROP_DISPLAY_COUNT,              /**< The number of displays */
+    DEVICE_PROP_DISPLAY0_BRIGHTNESS,        /**< The brightness of the main display */
+    DEVICE_PROP_DISPLAY0_MAX_BRIGHTNESS,    /**< The maximum brightness of the main display */
+    DEVICE_PROP_DISPLAY1_BRIGHTNESS,        /**< The brightness of the sub display */
+    DEVICE_PROP_DISPLAY1_MAX_BRIGHTNESS,    /**< The maximum brightness of the sub display */
+    DEVICE_PROP_BATTERY_PERCENT,            /**< The battery charge percentage (0 ~ 100) */
+    DEVICE_PROP_BATTERY_DETAIL,             /**< The battery charge as a per ten thousand (0 ~ 10000) */
+    DEVICE_PROP_BATTERY_FULL,               /**< 1 when the battery is fully charged, otherwise 0 */
+    DEVICE_PROP_BATTERY_CHARGING,           /**< 1 when the battery is charging, otherwise 0 */
+    DEVICE_PROP_BATTERY_WARNING,            /**< The battery warning status (#device_battery_warn_e) */
+    DEVICE_PROP_FLASH_BRIGHTNESS,           /**< The brightness of the camera flash LED */
+    DEVICE_PROP_FLASH_MAX_BRIGHTNESS,       /**< The maximum brightness of the camera flash LED */
+    DEVICE_PROP_MAX,                        /**< The number of properties */
+} device_prop_e;
+
+/**
+ * @brief Structure of a value read by device_query()
+ */
+typedef struct
+{
+    device_prop_e key;  /**< The property that was queried */
+    int error;          /**< #DEVICE_ERROR_NONE on success, otherwise the error the getter of the property would have returned */
+    int value;          /**< The value of the property, valid only when @a error is #DEVICE_ERROR_NONE */
+} device_value_s;
+
+/**
+ * @brief Enumerations of the callbacks that keep delivery statistics
+ */
+typedef enum
+{
+    DEVICE_CALLBACK_BATTERY,            /**< The callback set by device_battery_set_cb() */
+    DEVICE_CALLBACK_BATTERY_WARNING,    /**< The callback set by device_battery_warning_set_cb() */
+    DEVICE_CALLBACK_BATTERY_BATCH,      /**< The callback set by device_battery_set_batch_cb() */
+    DEVICE_CALLBACK_BATTERY_DETAIL,     /**< The callback set by device_battery_set_detail_cb() */
+    DEVICE_CALLBACK_MAX,                /**< The number of callbacks */
+} device_callback_e;
+
+/**
+ * @brief The number of buckets of the histograms in #device_callback_stats_s
+ */
+#define DEVICE_CALLBACK_HISTOGRAM_MAX 16
+
+/**
+ * @brief Structure of the delivery statistics of a callback
+ * @details Bucket 0 of a histogram counts durations under 2 microseconds,
+ * bucket n counts durations from 2^n up to 2^(n+1) microseconds and
+ * the last bucket counts everything longer.
+ */
+typedef struct
+{
+    unsigned int delivered;     /**< Notifications delivered to the callback */
+    unsigned int dropped;       /**< Notifications received while no callback was set */
+    unsigned int latency[DEVICE_CALLBACK_HISTOGRAM_MAX];   /**< Time from the notification reaching the library to the callback entry */
+    unsigned int duration[DEVICE_CALLBACK_HISTOGRAM_MAX];  /**< Time spent inside the callback */
+    unsigned int queue_max;     /**< Highest number of notifications waiting in the queue of #DEVICE_EXECUTOR_THREAD */
+    unsigned int overflow;      /**< Notifications discarded because the queue of #DEVICE_EXECUTOR_THREAD was full */
+    unsigned int coalesced;     /**< Notifications merged into the delivery of another one */
+} device_callback_stats_s;
+
+/**
+ * @brief Enumerations of the contexts a callback can be invoked in
+ */
+typedef enum
+{
+    DEVICE_EXECUTOR_INLINE,     /**< In the thread that received the system notification (default) */
+    DEVICE_EXECUTOR_THREAD,     /**< In a library thread dedicated to the callback, fed by a bounded queue */
+    DEVICE_EXECUTOR_DISPATCH,   /**< In whatever context the dispatch function passed to device_callback_set_executor() hands it to */
+} device_executor_e;
+
+/**
+ * @brief Called with a notification that is due to a callback using #DEVICE_EXECUTOR_DISPATCH.
+ * @details The function must arrange for device_callback_deliver() to be called with the same
+ * @a callback, @a value and @a stamp, for example from the main loop of the application.
+ *
+ * @param[in] callback      The callback the notification is due to
+ * @param[in] value         An opaque value to pass to device_callback_deliver()
+ * @param[in] stamp         An opaque value to pass to device_callback_deliver()
+ * @param[in] user_data     The user data passed to device_callback_set_executor()
+ *
+ */
+typedef void (*device_dispatch_cb)(device_callback_e callback, int value, unsigned long long stamp, void *user_data);
+
 /**
  * @}
 */
@@ -68,59 +170,600 @@ typedef enum
 /**
  * @brief Called when an battery charge percentage changed
  *
- * @param[in] percent       The remaining battery charge percentage (0 ~ 100)
- * @param[in] user_data     The user data passed from the callback registration function
+ * @param[in] percent       The remaining battery charge percentage (0 ~ 100)
+ * @param[in] user_data     The user data passed from the callback registration function
+ *
+ */
+typedef void (*device_battery_cb)(int percent, void *user_data); 
+
+/**
+ * @brief Called when the battery detail charge changed by at least the minimum delta
+ *
+ * @param[in] detail        The remaining battery charge as a per ten thousand (0 ~ 10000)
+ * @param[in] user_data     The user data passed from the callback registration function
+ *
+ */
+typedef void (*device_battery_detail_cb)(int detail, void *user_data);
+
+/**
+ * @brief Structure of a battery history sample
+ */
+typedef struct
+{
+    unsigned long long time;    /**< The time of the sample, in milliseconds since the Epoch */
+    int percent;                /**< The remaining battery charge percentage (0 ~ 100) */
+    int detail;                 /**< The remaining battery charge as a per ten thousand (0 ~ 10000), -1 if not supported */
+    bool charging;              /**< true when the battery was charging */
+} device_battery_sample_s;
+
+/**
+ * @brief Called for each sample of a battery history range.
+ *
+ * @param[in] sample        The sample, valid only during the callback
+ * @param[in] user_data     The user data passed from device_battery_history_foreach()
+ *
+ * @return @c true to continue with the next sample, otherwise @c false to stop
+ */
+typedef bool (*device_battery_history_cb)(const device_battery_sample_s *sample, void *user_data);
+
+/**
+ * @brief Enumerations of the curves mapping a perceptual brightness percentage to a brightness level
+ */
+typedef enum
+{
+    DEVICE_BRIGHTNESS_CURVE_LIGHTNESS,  /**< CIE 1976 lightness, equal steps look equally bright (default) */
+    DEVICE_BRIGHTNESS_CURVE_GAMMA,      /**< Power law with a gamma of 2.2 */
+    DEVICE_BRIGHTNESS_CURVE_LINEAR,     /**< Proportional to the brightness level */
+    DEVICE_BRIGHTNESS_CURVE_MAX,        /**< The number of curves */
+} device_brightness_curve_e;
+
+/**
+ * @brief Enumerations of the subsystems of the device backend
+ */
+typedef enum
+{
+    DEVICE_SUBSYSTEM_DISPLAY,   /**< The displays */
+    DEVICE_SUBSYSTEM_BATTERY,   /**< The battery */
+    DEVICE_SUBSYSTEM_FLASH,     /**< The camera flash LED */
+    DEVICE_SUBSYSTEM_SETTINGS,  /**< The system settings (battery status keys) */
+    DEVICE_SUBSYSTEM_MAX,       /**< The number of subsystems */
+} device_subsystem_e;
+
+/**
+ * @brief Enumerations of the states of the circuit breaker of a subsystem
+ */
+typedef enum
+{
+    DEVICE_BREAKER_CLOSED,      /**< Calls go to the backend */
+    DEVICE_BREAKER_OPEN,        /**< The backend is considered down, calls fail without reaching it */
+    DEVICE_BREAKER_HALF_OPEN,   /**< One call probes whether the backend is back */
+} device_breaker_e;
+
+/**
+ * @brief Structure of the retry policy of the backend calls, see device_set_retry_policy()
+ */
+typedef struct
+{
+    int attempts;               /**< The number of attempts of a failing call, 1 disables the retries */
+    int base_delay_ms;          /**< The delay before the first retry, doubled for every following one */
+    int max_delay_ms;           /**< The largest delay between two attempts */
+    int breaker_threshold;      /**< The number of failed calls in a row that opens the breaker, 0 disables it */
+    int breaker_cooldown_ms;    /**< The time the breaker stays open before probing, doubled while probes fail */
+} device_retry_policy_s;
+
+/**
+ * @brief Structure of the statistics of a subsystem, see device_subsystem_get_stats()
+ */
+typedef struct
+{
+    unsigned long long calls;       /**< The number of calls that reached the backend, retries excluded */
+    unsigned long long failures;    /**< The number of calls that failed after every attempt */
+    unsigned long long retries;     /**< The number of retried attempts */
+    unsigned long long rejected;    /**< The number of calls failed by the open breaker */
+    unsigned long long trips;       /**< The number of times the breaker opened */
+    device_breaker_e breaker;       /**< The current state of the breaker */
+} device_subsystem_stats_s;
+
+/**
+ * @brief Enumerations of the events device_wait_once() can wait for
+ */
+typedef enum
+{
+    DEVICE_WAIT_BATTERY_CAPACITY,   /**< The battery charge percentage changed, the value is the percentage */
+    DEVICE_WAIT_BATTERY_CHARGING,   /**< The charging state changed, the value is 1 when charging, otherwise 0 */
+    DEVICE_WAIT_BATTERY_WARNING,    /**< The battery warning status changed, the value is a #device_battery_warn_e */
+    DEVICE_WAIT_MAX,                /**< The number of events */
+} device_wait_e;
+
+/**
+ * @brief Called once with the notification a waiter waited for.
+ *
+ * @remarks It is invoked in the thread that delivers the notification, the waiter may be reused from it.
+ *
+ * @param[in] error         #DEVICE_ERROR_NONE
+ * @param[in] value         The value of the event, see #device_wait_e
+ * @param[in] user_data     The user data passed from device_wait_once()
+ */
+typedef void (*device_wait_cb)(int error, int value, void *user_data);
+
+/**
+ * @brief Structure of a pending wait, owned by the caller and managed by device_wait_once().
+ * @remarks The members are private. A waiter never passed to device_wait_once() must be zero-initialized.
+ */
+typedef struct _device_waiter_s
+{
+    struct _device_waiter_s *next;  /**< Private */
+    device_wait_cb callback;        /**< Private */
+    void *user_data;                /**< Private */
+    int event;                      /**< Private */
+    int pending;                    /**< Private */
+} device_waiter_s;
+
+/**
+ * @brief The number of displays a #device_scene_s can set
+ */
+#define DEVICE_SCENE_DISPLAY_MAX 2
+
+/**
+ * @brief The value of a #device_scene_s member that is left unchanged
+ */
+#define DEVICE_SCENE_UNCHANGED (-1)
+
+/**
+ * @brief Structure of a combined display and flash LED state, applied with device_scene_apply()
+ */
+typedef struct
+{
+    int display_brightness[DEVICE_SCENE_DISPLAY_MAX];   /**< The brightness of each display index, or #DEVICE_SCENE_UNCHANGED */
+    int flash_brightness;                               /**< The brightness of the camera flash LED, or #DEVICE_SCENE_UNCHANGED */
+} device_scene_s;
+
+/**
+ * @brief The brightness lease handle
+ */
+typedef struct _device_brightness_lease_s *device_brightness_lease_h;
+
+/**
+ * @brief The battery series handle
+ */
+typedef struct _device_battery_series_s *device_battery_series_h;
+
+/**
+ * @brief Enumerations of the value columns of a battery series
+ */
+typedef enum
+{
+    DEVICE_BATTERY_SERIES_PERCENT,  /**< The battery charge percentage */
+    DEVICE_BATTERY_SERIES_DETAIL,   /**< The battery detail charge */
+} device_battery_series_e;
+
+/**
+ * @brief Structure of the aggregates of a window of a battery series
+ */
+typedef struct
+{
+    int count;          /**< The number of samples in the window */
+    int min;            /**< The smallest value */
+    int max;            /**< The largest value */
+    double mean;        /**< The mean value */
+    double variance;    /**< The population variance of the values */
+    double rate;        /**< The least squares slope of the values over time, per hour (negative while draining) */
+} device_battery_aggregate_s;
+
+/**
+ * @brief Enumerations of the changes reported to a #device_battery_batch_cb
+ */
+typedef enum
+{
+    DEVICE_CHANGE_BATTERY_PERCENT   = 1 << 0,   /**< The battery charge percentage changed */
+    DEVICE_CHANGE_BATTERY_CHARGING  = 1 << 1,   /**< The charging state changed */
+    DEVICE_CHANGE_BATTERY_WARNING   = 1 << 2,   /**< The battery warning status changed */
+} device_change_e;
+
+/**
+ * @brief Structure of the battery state delivered to a #device_battery_batch_cb
+ */
+typedef struct
+{
+    int percent;                    /**< The remaining battery charge percentage (0 ~ 100) */
+    bool charging;                  /**< true when the battery is charging */
+    device_battery_warn_e warning;  /**< The battery warning status */
+} device_battery_state_s;
+
+/**
+ * @brief Called at most once per delivery window with the battery changes of the window.
+ *
+ * @param[in] changes       The bitwise OR of the #device_change_e that happened during the window
+ * @param[in] state         The latest battery state, valid only during the callback
+ * @param[in] user_data     The user data passed from the callback registration function
+ *
+ */
+typedef void (*device_battery_batch_cb)(unsigned int changes, const device_battery_state_s *state, void *user_data);
+
+/**
+ * @brief Called when the device warn about the battery status.
+ *
+ * @param[in] status       The battery warning status
+ * @param[in] user_data    The user data passed from the callback registration function
+ *
+ */
+typedef void (*device_battery_warn_cb)(device_battery_warn_e status, void *user_data);
+
+/**
+ * @brief Gets the battery warning status.
+ *
+ * @param[out] status The battery warning status.
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_battery_status_e
+ * @see device_battery_status_set_cb()
+ */
+int device_battery_get_warning_status(device_battery_warn_e *status);
+
+/**
+ * @brief Set callback to be observing battery warning.
+ *
+ * @param[in] callback      The callback function to set
+ * @param[in] user_data     The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_battery_status_e
+ * @see device_battery_get_status()
+ */
+int device_battery_warning_set_cb(device_battery_warn_cb callback, void* user_data);
+
+/**
+ * @brief Unset battery warning callback function.
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE               Successful
+ * @retval #DEVICE_ERROR_OPERATION_FAILED   Operation failed
+ */
+int device_battery_warning_unset_cb(void);
+
+/**
+ * @brief Set callback to be observed battery warning, for some warning statuses only.
+ * @details The callback is invoked only when the battery warning status changes to one of the statuses in @a levels,
+ * other changes are filtered out by the library and never wake the subscriber.\n
+ * It replaces the callback set by device_battery_warning_set_cb(), which is the same as passing
+ * #DEVICE_BATTERY_WARN_MASK_ALL, and is unset by device_battery_warning_unset_cb().
+ *
+ * @param[in] levels        The bitwise OR of the #DEVICE_BATTERY_WARN_MASK of the statuses to observe
+ * @param[in] callback      The callback function to set
+ * @param[in] user_data     The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_battery_warning_set_cb()
+ */
+int device_battery_warning_set_level_cb(unsigned int levels, device_battery_warn_cb callback, void* user_data);
+
+/**
+ * @brief Set callback to be observed battery changes in batches.
+ * @details Changes of the battery charge percentage, the charging state and the battery warning status
+ * are held back and delivered together in a single callback at the end of the delivery window they
+ * happened in, so that back-to-back changes wake the subscriber only once.\n
+ * The windows are aligned on the monotonic clock, so every batched subscriber of the process
+ * with the same window is woken at the same time.
+ *
+ * @param[in] window_ms     The length of the delivery window in milliseconds, greater than 0
+ * @param[in] callback      The callback function to set
+ * @param[in] user_data     The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_battery_unset_batch_cb()
+ */
+int device_battery_set_batch_cb(int window_ms, device_battery_batch_cb callback, void *user_data);
+
+/**
+ * @brief Unset battery batch callback function.
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE               Successful
+ * @retval #DEVICE_ERROR_OPERATION_FAILED   Operation failed
+ */
+int device_battery_unset_batch_cb(void);
+
+/**
+ * @brief Set callback to be observed battery detail charge changes.
+ * @details The detail charge has no system notification, so the library samples it.
+ * The sampling period follows the observed discharge rate: it is short while the charge moves quickly,
+ * grows while the charge is stable and is kept long while the device is on a charger.
+ * A change of the battery charge percentage or of the charging state triggers a sample at once.\n
+ * The callback is invoked when the sampled value differs from the last delivered one by at least @a min_delta.
+ *
+ * @param[in] min_delta     The minimum change to report as a per ten thousand, greater than 0
+ * @param[in] callback      The callback function to set
+ * @param[in] user_data     The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ * @retval #DEVICE_ERROR_NOT_SUPPORTED      Not supported device
+ *
+ * @see device_battery_get_detail()
+ * @see device_battery_unset_detail_cb()
+ */
+int device_battery_set_detail_cb(int min_delta, device_battery_detail_cb callback, void *user_data);
+
+/**
+ * @brief Unset battery detail callback function.
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE               Successful
+ * @retval #DEVICE_ERROR_OPERATION_FAILED   Operation failed
+ */
+int device_battery_unset_detail_cb(void);
+
+/**
+ * @brief Starts recording the battery history to a file.
+ * @details A sample is appended when the battery charge percentage or the charging state changes,
+ * and when the sampled detail charge moved noticeably. Samples are appended to the existing history of @a path.\n
+ * The file is compact: each sample is stored as the difference from the previous one.
+ *
+ * @param[in] path  The path of the history file
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter, or @a path is not a battery history
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ * @retval #DEVICE_ERROR_RESOURCE_BUSY		The history is already being recorded
+ *
+ * @see device_battery_history_stop()
+ * @see device_battery_history_foreach()
+ */
+int device_battery_history_start(const char *path);
+
+/**
+ * @brief Stops recording the battery history.
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE               Successful
+ * @retval #DEVICE_ERROR_OPERATION_FAILED   The history is not being recorded
+ */
+int device_battery_history_stop(void);
+
+/**
+ * @brief Retrieves the samples of a battery history file recorded in a time range.
+ * @details The file is mapped and decoded while the samples are delivered, it is never loaded as a whole.
+ * Samples are delivered in the order they were recorded.
+ *
+ * @param[in] path          The path of the history file
+ * @param[in] from          The start of the range, in milliseconds since the Epoch
+ * @param[in] to            The end of the range (included), in milliseconds since the Epoch
+ * @param[in] callback      The callback function to invoke for each sample
+ * @param[in] user_data     The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter, or @a path is not a battery history
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_battery_history_start()
+ */
+int device_battery_history_foreach(const char *path, unsigned long long from, unsigned long long to,
+		device_battery_history_cb callback, void *user_data);
+
+/**
+ * @brief Loads the samples of a battery history file recorded in a time range into a series.
+ * @details A series keeps the times, percentages and detail charges in separate arrays,
+ * so that windows of it can be aggregated with vector instructions by device_battery_series_aggregate().\n
+ * The samples are sorted by time, samples of the same time in the order they were recorded,
+ * even where the history file has them out of order because the system clock was set back.
+ * @remarks The @a series must be released with device_battery_series_destroy().
+ *
+ * @param[in] path      The path of the history file
+ * @param[in] from      The start of the range, in milliseconds since the Epoch
+ * @param[in] to        The end of the range (included), in milliseconds since the Epoch
+ * @param[out] series   The series
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter, or @a path is not a battery history
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_battery_history_start()
+ */
+int device_battery_series_create(const char *path, unsigned long long from, unsigned long long to,
+		device_battery_series_h *series);
+
+/**
+ * @brief Releases a battery series.
+ *
+ * @param[in] series    The series
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ */
+int device_battery_series_destroy(device_battery_series_h series);
+
+/**
+ * @brief Gets the number of samples of a battery series.
+ *
+ * @param[in] series    The series
+ * @param[out] count    The number of samples
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ */
+int device_battery_series_get_count(device_battery_series_h series, int *count);
+
+/**
+ * @brief Gets the index of the first sample of a battery series recorded at or after a time.
+ *
+ * @param[in] series    The series
+ * @param[in] time      The time, in milliseconds since the Epoch
+ * @param[out] index    The index of the sample, the number of samples if there is none
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ */
+int device_battery_series_get_index(device_battery_series_h series, unsigned long long time, int *index);
+
+/**
+ * @brief Aggregates a window of a battery series.
+ *
+ * @param[in] series    The series
+ * @param[in] column    The values to aggregate
+ * @param[in] index     The index of the first sample of the window
+ * @param[in] count     The number of samples of the window, greater than 0
+ * @param[out] result   The aggregates
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter, or the window is out of the series
+ * @retval #DEVICE_ERROR_NOT_SUPPORTED		The detail charge of a sample in the window was not supported (#DEVICE_BATTERY_SERIES_DETAIL)
+ */
+int device_battery_series_aggregate(device_battery_series_h series, device_battery_series_e column,
+		int index, int count, device_battery_aggregate_s *result);
+
+/**
+ * @brief Selects the curve used by the perceptual brightness functions of a display.
+ *
+ * @param[in] display_index	The index of the display, it be greater than or equal to 0 and less than \n
+ *                          the number of displays returned by device_get_display_numbers().
+ * @param[in] curve         The curve
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_set_brightness_percent()
+ */
+int device_set_brightness_curve(int display_index, device_brightness_curve_e curve);
+
+/**
+ * @brief Sets the display brightness as a perceptual percentage.
+ * @details The percentage is mapped to a brightness level through the curve of the display,
+ * so that equal steps of the percentage look like equal steps of brightness.
+ * The mapping is a table lookup, built once per display from its maximum brightness.\n
+ * Any percentage above 0 keeps the display lit.
+ *
+ * @param[in] display_index	The index of the display, it be greater than or equal to 0 and less than \n
+ *                          the number of displays returned by device_get_display_numbers().
+ * @param[in] percent       The perceptual brightness (0 ~ 100)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_set_brightness_curve()
+ * @see device_get_brightness_percent()
+ */
+int device_set_brightness_percent(int display_index, int percent);
+
+/**
+ * @brief Gets the display brightness as a perceptual percentage.
+ * @details The brightness level is mapped back through the curve of the display, to the closest percentage.
+ *
+ * @param[in] display_index	The index of the display, it be greater than or equal to 0 and less than \n
+ *                          the number of displays returned by device_get_display_numbers().
+ * @param[out] percent      The perceptual brightness (0 ~ 100)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
  *
+ * @see device_set_brightness_percent()
  */
-typedef void (*device_battery_cb)(int percent, void *user_data); 
+int device_get_brightness_percent(int display_index, int *percent);
 
 /**
- * @brief Called when the device warn about the battery status.
+ * @brief Acquires a brightness lease on a display.
+ * @details Of the leases held on a display, the one with the highest priority sets its brightness;
+ * among leases of equal priority the latest acquired one wins.
+ * The brightness is written when the winning value changes,
+ * and it returns to the settings when the last lease is released.\n
+ * Leases are arbitrated within the process. device_set_brightness() and device_scene_apply() are not arbitrated:
+ * their value holds until the next acquire, update or release of a lease of the display, which writes the winner again.
+ * @remarks The @a lease must be released with device_brightness_lease_release().
  *
- * @param[in] status       The battery warning status
- * @param[in] user_data    The user data passed from the callback registration function
+ * @param[in] display_index	The index of the display, it be greater than or equal to 0 and less than \n
+ *                          the number of displays returned by device_get_display_numbers().
+ * @param[in] priority      The priority of the lease, higher wins
+ * @param[in] value         The brightness level (0 ~ maximum brightness)
+ * @param[out] lease        The lease
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
  *
+ * @see device_brightness_lease_update()
+ * @see device_brightness_lease_release()
  */
-typedef void (*device_battery_warn_cb)(device_battery_warn_e status, void *user_data);
+int device_brightness_lease_acquire(int display_index, int priority, int value, device_brightness_lease_h *lease);
 
 /**
- * @brief Gets the battery warning status.
+ * @brief Changes the brightness level of a brightness lease.
+ * @details The brightness is written only if the lease is winning.
+ *
+ * @param[in] lease     The lease
+ * @param[in] value     The brightness level (0 ~ maximum brightness)
  *
- * @param[out] status The battery warning status.
  * @return 0 on success, otherwise a negative error value.
  * @retval #DEVICE_ERROR_NONE				Successful
  * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
  * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
  *
- * @see device_battery_status_e
- * @see device_battery_status_set_cb()
+ * @see device_brightness_lease_acquire()
  */
-int device_battery_get_warning_status(device_battery_warn_e *status);
+int device_brightness_lease_update(device_brightness_lease_h lease, int value);
 
 /**
- * @brief Set callback to be observing battery warning.
+ * @brief Releases a brightness lease.
+ * @details The next winning lease sets the brightness, or the settings do if it was the last lease.
  *
- * @param[in] callback      The callback function to set
- * @param[in] user_data     The user data to be passed to the callback function
+ * @param[in] lease     The lease
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #DEVICE_ERROR_NONE				Successful
  * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
- * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	The lease was released, but the brightness could not be written
  *
- * @see device_battery_status_e
- * @see device_battery_get_status()
+ * @see device_brightness_lease_acquire()
  */
-int device_battery_warning_set_cb(device_battery_warn_cb callback, void* user_data);
+int device_brightness_lease_release(device_brightness_lease_h lease);
 
 /**
- * @brief Unset battery warning callback function.
+ * @brief Applies the brightness of the displays and of the camera flash LED at once.
+ * @details Every value is validated against the cached maximum brightness before anything is written.
+ * If a write fails, the values already written are restored.
+ * Values equal to the current ones are not written. Scenes are applied one at a time.\n
+ * A scene is not arbitrated with the brightness leases: its display brightness holds until the next
+ * acquire, update or release of a lease of the display, which writes the winning lease again.
+ *
+ * @param[in] scene     The state to apply
  *
  * @return 0 on success, otherwise a negative error value.
- * @retval #DEVICE_ERROR_NONE               Successful
- * @retval #DEVICE_ERROR_OPERATION_FAILED   Operation failed
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter, nothing was written
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed, the previous state was restored
+ *
+ * @see device_set_brightness()
+ * @see device_flash_set_brightness()
  */
-int device_battery_warning_unset_cb(void);
+int device_scene_apply(const device_scene_s *scene);
 
 /**
  * @brief Gets the battery charge percentage.
@@ -310,6 +953,51 @@ int device_get_max_brightness(int display_index, int *max_brightness);
  */
 int device_set_brightness_from_settings(int display_index);
 
+/**
+ * @brief Gets the display brightness value of a display index the caller already validated.
+ * @details Unlike device_get_brightness() it does not query the number of displays, the index is only
+ * checked against the displays the platform can address (#DEVICE_SCENE_DISPLAY_MAX, 1 in a single display build).
+ *
+ * @remarks An index the device does not have fails with #DEVICE_ERROR_OPERATION_FAILED instead of
+ * #DEVICE_ERROR_INVALID_PARAMETER. The C++ Display<N> type of device.hpp uses it for indices checked at compile time.\n
+ * A library built for a single display (its pkg-config flags define DEVICE_SINGLE_DISPLAY) only addresses
+ * index 0, any other index fails with #DEVICE_ERROR_INVALID_PARAMETER.
+ *
+ * @param[in] display_index	The index of the display
+ * @param[out] brightness	The current brightness value of the display
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_get_brightness()
+ */
+int device_get_brightness_unchecked(int display_index, int *brightness);
+
+/**
+ * @brief Sets the display brightness value of a display index the caller already validated.
+ * @details Unlike device_set_brightness() it does not query the number of displays, the index is only
+ * checked against the displays the platform can address (#DEVICE_SCENE_DISPLAY_MAX, 1 in a single display build). The value is
+ * still checked against the maximum brightness of the display.
+ *
+ * @remarks An index the device does not have fails with #DEVICE_ERROR_OPERATION_FAILED instead of
+ * #DEVICE_ERROR_INVALID_PARAMETER.\n
+ * A library built for a single display (its pkg-config flags define DEVICE_SINGLE_DISPLAY) only addresses
+ * index 0, any other index fails with #DEVICE_ERROR_INVALID_PARAMETER.
+ *
+ * @param[in] display_index	The index of the display
+ * @param[in] brightness	The new brightness value to set
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_set_brightness()
+ */
+int device_set_brightness_unchecked(int display_index, int brightness);
+
 /**
  * @brief Get brightness value of LED that placed to camera flash.
  *
@@ -351,6 +1039,361 @@ int device_flash_set_brightness(int brightness);
  */
 int device_flash_get_max_brightness(int *max_brightness);
 
+/**
+ * @brief Called when an asynchronous request completes.
+ *
+ * @remarks This callback is invoked in a library worker thread, not in the thread that made the request.
+ *
+ * @param[in] request_id    The request id returned by the asynchronous function
+ * @param[in] error         #DEVICE_ERROR_NONE on success, otherwise the error the synchronous function would have returned
+ * @param[in] value         The value read (or written) by the request, valid only when @a error is #DEVICE_ERROR_NONE
+ * @param[in] user_data     The user data passed from the asynchronous function
+ *
+ */
+typedef void (*device_async_cb)(int request_id, int error, int value, void *user_data);
+
+/**
+ * @brief Gets the display brightness value without blocking the caller.
+ * @details The request is executed by a library worker thread and the result is delivered to @a callback.\n
+ * Requests for the same display are executed in the order they were made.
+ *
+ * @param[in] display_index	The index of the display, it be greater than or equal to 0 and less than \n
+ *                          the number of displays returned by device_get_display_numbers().
+ * @param[in] callback      The callback function to be invoked with the brightness value
+ * @param[in] user_data     The user data to be passed to the callback function
+ * @param[out] request_id   The id of the request, it can be passed to device_async_cancel() (may be NULL)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ * @retval #DEVICE_ERROR_RESOURCE_BUSY		Too many pending requests
+ *
+ * @see device_get_brightness()
+ * @see device_async_cancel()
+ */
+int device_get_brightness_async(int display_index, device_async_cb callback, void *user_data, int *request_id);
+
+/**
+ * @brief Sets the display brightness value without blocking the caller.
+ * @details The request is executed by a library worker thread and the result is delivered to @a callback.\n
+ * Requests for the same display are executed in the order they were made.
+ *
+ * @param[in] display_index	The index of the display, it be greater than or equal to 0 and less than \n
+ *                          the number of displays returned by device_get_display_numbers().
+ * @param[in] brightness	The new brightness value to set
+ * @param[in] callback      The callback function to be invoked when the value is set (may be NULL)
+ * @param[in] user_data     The user data to be passed to the callback function
+ * @param[out] request_id   The id of the request, it can be passed to device_async_cancel() (may be NULL)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ * @retval #DEVICE_ERROR_RESOURCE_BUSY		Too many pending requests
+ *
+ * @see device_set_brightness()
+ * @see device_async_cancel()
+ */
+int device_set_brightness_async(int display_index, int brightness, device_async_cb callback, void *user_data, int *request_id);
+
+/**
+ * @brief Gets the battery charge percentage without blocking the caller.
+ *
+ * @param[in] callback      The callback function to be invoked with the battery charge percentage
+ * @param[in] user_data     The user data to be passed to the callback function
+ * @param[out] request_id   The id of the request, it can be passed to device_async_cancel() (may be NULL)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ * @retval #DEVICE_ERROR_RESOURCE_BUSY		Too many pending requests
+ *
+ * @see device_battery_get_percent()
+ * @see device_async_cancel()
+ */
+int device_battery_get_percent_async(device_async_cb callback, void *user_data, int *request_id);
+
+/**
+ * @brief Gets the battery detail charge without blocking the caller.
+ *
+ * @param[in] callback      The callback function to be invoked with the battery detail charge
+ * @param[in] user_data     The user data to be passed to the callback function
+ * @param[out] request_id   The id of the request, it can be passed to device_async_cancel() (may be NULL)
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ * @retval #DEVICE_ERROR_RESOURCE_BUSY		Too many pending requests
+ *
+ * @see device_battery_get_detail()
+ * @see device_async_cancel()
+ */
+int device_battery_get_detail_async(device_async_cb callback, void *user_data, int *request_id);
+
+/**
+ * @brief Cancels a pending asynchronous request.
+ * @details The callback of a canceled request is never invoked.\n
+ * A request that already started executing can not be canceled.
+ *
+ * @param[in] request_id    The request id returned by the asynchronous function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	The request is unknown, running or already completed
+ */
+int device_async_cancel(int request_id);
+
+/**
+ * @brief The timeout value that selects the process default, see device_set_thread_timeout()
+ */
+#define DEVICE_TIMEOUT_DEFAULT (-1)
+
+/**
+ * @brief Sets the default deadline of the calls of the process.
+ * @details A call whose deadline passes while the device is not answering returns #DEVICE_ERROR_TIMED_OUT
+ * instead of blocking the caller; the stalled request completes in the background and its result is discarded.\n
+ * An asynchronous request times out from when it was made, including the time it waited in the queue.\n
+ * The initial default is 0, no deadline, unless CAPI_SYSTEM_DEVICE_TIMEOUT gives one in milliseconds.
+ *
+ * @param[in] timeout_ms    The deadline of a call in milliseconds, or 0 for none
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_set_thread_timeout()
+ */
+int device_set_timeout(int timeout_ms);
+
+/**
+ * @brief Overrides the default deadline for the calls made by the calling thread.
+ * @details The override applies to every following call of the thread, including the asynchronous requests it makes,
+ * until it is set back to #DEVICE_TIMEOUT_DEFAULT.
+ *
+ * @param[in] timeout_ms    The deadline of a call in milliseconds, 0 for none, or #DEVICE_TIMEOUT_DEFAULT
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_set_timeout()
+ */
+int device_set_thread_timeout(int timeout_ms);
+
+/**
+ * @brief Sets the retry policy of the backend calls.
+ * @details A failing backend call is retried after an exponentially growing delay with a random jitter,
+ * so that clients do not retry in lockstep, and never past the deadline of the call (see device_set_timeout()).
+ * When calls to a subsystem keep failing, its circuit breaker opens and its calls fail at once with
+ * #DEVICE_ERROR_OPERATION_FAILED until a probe call succeeds.\n
+ * A call the device does not support is neither retried nor counted as a failure. Calls made by an inline callback
+ * (#DEVICE_EXECUTOR_INLINE) and the writes of the brightness leases are not retried, so as not to hold back
+ * the other notifications and leases.\n
+ * The default policy is 3 attempts, 10 ms to 200 ms apart, and a breaker opening after 5 failed calls for 1 second.
+ *
+ * @param[in] policy    The retry policy
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_get_retry_policy()
+ * @see device_subsystem_get_stats()
+ */
+int device_set_retry_policy(const device_retry_policy_s *policy);
+
+/**
+ * @brief Gets the retry policy of the backend calls.
+ *
+ * @param[out] policy   The retry policy
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_set_retry_policy()
+ */
+int device_get_retry_policy(device_retry_policy_s *policy);
+
+/**
+ * @brief Gets the call statistics and the breaker state of a subsystem.
+ *
+ * @param[in] subsystem The subsystem
+ * @param[out] stats    The statistics
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_subsystem_reset_stats()
+ */
+int device_subsystem_get_stats(device_subsystem_e subsystem, device_subsystem_stats_s *stats);
+
+/**
+ * @brief Clears the call statistics of a subsystem, the breaker state is kept.
+ *
+ * @param[in] subsystem The subsystem
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_subsystem_get_stats()
+ */
+int device_subsystem_reset_stats(device_subsystem_e subsystem);
+
+/**
+ * @brief Reads several device properties at once.
+ * @details Every distinct property is read from the backend only once,
+ * no matter how many times it appears in @a keys, and shared lookups such as
+ * the number of displays are done once for the whole query.\n
+ * The result of each key is stored in the element of @a values with the same index.
+ *
+ * @param[in] keys      The properties to read
+ * @param[in] count     The number of elements in @a keys and @a values
+ * @param[out] values   The values of the properties
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful, the error of each property is stored in @a values
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_prop_e
+ */
+int device_query(const device_prop_e *keys, int count, device_value_s *values);
+
+/**
+ * @brief Gets the properties that changed since a generation.
+ * @details The library keeps a monotonic generation counter that is incremented on every observed change
+ * of the battery charge percentage, the charging state, the battery warning status, the brightness of each display
+ * and the camera flash brightness.\n
+ * Only these properties are reported, each at most once with its latest value.
+ * Pass 0 as @a generation to get all of them, then pass the returned @a current_generation on the next call.
+ * @remarks Changes of the battery properties are observed from the system notifications.
+ * Changes of the display and flash brightness are observed only when they are made through this library.\n
+ * The first call starts the tracking.
+ *
+ * @param[in] generation            The generation returned by the previous call, or 0
+ * @param[out] current_generation   The current generation
+ * @param[out] values               The changed properties and their values
+ * @param[in] max_count             The number of elements in @a values
+ * @param[out] count                The number of changed properties stored in @a values
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_query()
+ */
+int device_changes_since(unsigned int generation, unsigned int *current_generation,
+		device_value_s *values, int max_count, int *count);
+
+/**
+ * @brief Gets the delivery statistics of a callback.
+ * @details The statistics are accumulated since the process started or since the last device_callback_reset_stats().
+ *
+ * @param[in] callback  The callback
+ * @param[out] stats    The delivery statistics
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_callback_reset_stats()
+ */
+int device_callback_get_stats(device_callback_e callback, device_callback_stats_s *stats);
+
+/**
+ * @brief Clears the delivery statistics of a callback.
+ *
+ * @param[in] callback  The callback
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_callback_get_stats()
+ */
+int device_callback_reset_stats(device_callback_e callback);
+
+/**
+ * @brief Sets the context a callback is invoked in.
+ * @details With #DEVICE_EXECUTOR_INLINE a slow callback delays the delivery of every other system notification
+ * of the process. #DEVICE_EXECUTOR_THREAD and #DEVICE_EXECUTOR_DISPATCH only queue the notification in the
+ * notification context, so a slow callback only delays itself.\n
+ * Notifications already queued when the executor changes are still delivered by the previous executor.
+ *
+ * @param[in] callback      The callback
+ * @param[in] executor      The executor
+ * @param[in] dispatch      The dispatch function, required by #DEVICE_EXECUTOR_DISPATCH and ignored otherwise
+ * @param[in] user_data     The user data to be passed to @a dispatch
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	The executor thread can not be started
+ *
+ * @see device_callback_deliver()
+ */
+int device_callback_set_executor(device_callback_e callback, device_executor_e executor,
+		device_dispatch_cb dispatch, void *user_data);
+
+/**
+ * @brief Invokes a callback with a notification handed to a #device_dispatch_cb.
+ * @details The callback is invoked in the calling thread, before this function returns.
+ *
+ * @param[in] callback      The callback passed to the dispatch function
+ * @param[in] value         The value passed to the dispatch function
+ * @param[in] stamp         The stamp passed to the dispatch function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see device_callback_set_executor()
+ */
+int device_callback_deliver(device_callback_e callback, int value, unsigned long long stamp);
+
+/**
+ * @brief Waits for the next notification of an event.
+ * @details The callback is invoked once, with the first notification after the call, and the waiter is then free.\n
+ * Any number of waiters can wait for the same event, the library allocates nothing for them.
+ *
+ * @remarks The waiter must stay valid until the callback starts or device_wait_cancel() returns.
+ *
+ * @param[in] event         The event to wait for
+ * @param[in] waiter        The storage of the wait
+ * @param[in] callback      The callback function to be invoked with the notification
+ * @param[in] user_data     The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #DEVICE_ERROR_OPERATION_FAILED	Operation failed
+ *
+ * @see device_wait_cancel()
+ */
+int device_wait_once(device_wait_e event, device_waiter_s *waiter, device_wait_cb callback, void *user_data);
+
+/**
+ * @brief Cancels a wait started by device_wait_once().
+ * @details A wait whose notification is being delivered to other waiters is still canceled if its own callback
+ * has not started. If its callback is running in another thread, this waits for it to return, so the waiter
+ * can be released as soon as this returns. A wait must therefore not be canceled while holding a lock its callback takes.
+ *
+ * @param[in] waiter        The storage of the wait
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #DEVICE_ERROR_NONE				Successful, the callback will not be invoked
+ * @retval #DEVICE_ERROR_INVALID_PARAMETER	The waiter is not pending, its callback was or is being invoked
+ *
+ * @see device_wait_once()
+ */
+int device_wait_cancel(device_waiter_s *waiter);
+
 /**
  * @}
  */
@@ -0,0 +1,402 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+
+#ifndef __TIZEN_SYSTEM_DEVICE_HPP__
+#define __TIZEN_SYSTEM_DEVICE_HPP__
+
+/*
+ * Header-only C++ layer of the device API (C++11).
+ *
+ * Every function is an inline forwarder to one call of device.h, results
+ * come back as a Result<T> instead of an out parameter, and callbacks are
+ * held by Subscription objects that unset them when destroyed. Nothing
+ * here throws, so it can be used with -fno-exceptions.
+ */
+
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <device.h>
+
+/*
+ * The display indices a program uses, Display<N> requires N below it.
+ * A product with a single panel defines it to 1 before including this
+ * header, so that Display<1> does not compile. It defaults to 1 against a
+ * single display build of the library, whose pkg-config flags define
+ * DEVICE_SINGLE_DISPLAY.
+ */
+#ifndef DEVICE_CXX_DISPLAY_MAX
+#ifdef DEVICE_SINGLE_DISPLAY
+#define DEVICE_CXX_DISPLAY_MAX 1
+#else
+#define DEVICE_CXX_DISPLAY_MAX DEVICE_SCENE_DISPLAY_MAX
+#endif
+#endif
+
+namespace device {
+
+static_assert(DEVICE_CXX_DISPLAY_MAX > 0 && DEVICE_CXX_DISPLAY_MAX <= DEVICE_SCENE_DISPLAY_MAX,
+		"DEVICE_CXX_DISPLAY_MAX must be between 1 and DEVICE_SCENE_DISPLAY_MAX");
+
+/* The error of a failed Result, see unexpected() */
+struct Unexpected {
+	explicit Unexpected(int error) : error(static_cast<device_error_e>(error)) {}
+	device_error_e error;
+};
+
+inline Unexpected unexpected(int error)
+{
+	return Unexpected(error);
+}
+
+/*
+ * A value or the device_error_e of the call that failed to produce it,
+ * shaped after std::expected. value() on a failed result is a programming
+ * error and asserts instead of throwing. T must be default constructible.
+ */
+template <typename T>
+class Result {
+public:
+	Result(T value) : value_(std::move(value)), error_(DEVICE_ERROR_NONE) {}
+	Result(Unexpected e) : value_(), error_(e.error) { assert(error_ != DEVICE_ERROR_NONE); }
+
+	bool has_value() const { return error_ == DEVICE_ERROR_NONE; }
+	explicit operator bool() const { return has_value(); }
+
+	T &value() { assert(has_value()); return value_; }
+	const T &value() const { assert(has_value()); return value_; }
+	T &operator*() { return value(); }
+	const T &operator*() const { return value(); }
+	T *operator->() { return &value(); }
+	const T *operator->() const { return &value(); }
+
+	template <typename U>
+	T value_or(U &&fallback) const { return has_value() ? value_ : static_cast<T>(std::forward<U>(fallback)); }
+
+	device_error_e error() const { return error_; }
+
+private:
+	T value_;
+	device_error_e error_;
+};
+
+template <>
+class Result<void> {
+public:
+	Result() : error_(DEVICE_ERROR_NONE) {}
+	Result(Unexpected e) : error_(e.error) { assert(error_ != DEVICE_ERROR_NONE); }
+
+	bool has_value() const { return error_ == DEVICE_ERROR_NONE; }
+	explicit operator bool() const { return has_value(); }
+	void value() const { assert(has_value()); }
+
+	device_error_e error() const { return error_; }
+
+private:
+	device_error_e error_;
+};
+
+namespace detail {
+
+template <typename T>
+inline Result<T> make_result(int ret, T value)
+{
+	if (ret != DEVICE_ERROR_NONE)
+		return unexpected(ret);
+	return Result<T>(std::move(value));
+}
+
+inline Result<void> make_result(int ret)
+{
+	if (ret != DEVICE_ERROR_NONE)
+		return unexpected(ret);
+	return Result<void>();
+}
+
+struct Slot;
+
+/*
+ * The C API has one callback slot per kind of notification. The slot that
+ * set it last is its owner, an older subscription being destroyed must
+ * not unset the callback of a newer one. Setting the C callback and
+ * publishing its owner, or unsetting it and clearing the owner, happen
+ * under the lock of the kind, so the two never disagree.
+ */
+struct Kind {
+	std::mutex lock;
+	std::atomic<Slot *> owner{nullptr};
+};
+
+struct Slot {
+	Slot(Kind &kind, int (*unset)(void)) : kind(kind), unset(unset) {}
+	virtual ~Slot() {}
+
+	Kind &kind;
+	int (*unset)(void);
+};
+
+inline Kind &battery_kind()
+{
+	static Kind kind;
+	return kind;
+}
+
+inline Kind &warning_kind()
+{
+	static Kind kind;
+	return kind;
+}
+
+template <typename F>
+struct BatterySlot : Slot {
+	explicit BatterySlot(F f) : Slot(battery_kind(), device_battery_unset_cb), f(std::move(f)) {}
+
+	static void invoke(int percent, void *data)
+	{
+		static_cast<BatterySlot *>(data)->f(percent);
+	}
+
+	F f;
+};
+
+template <typename F>
+struct WarningSlot : Slot {
+	explicit WarningSlot(F f) : Slot(warning_kind(), device_battery_warning_unset_cb), f(std::move(f)) {}
+
+	static void invoke(device_battery_warn_e status, void *data)
+	{
+		static_cast<WarningSlot *>(data)->f(status);
+	}
+
+	F f;
+};
+
+} // namespace detail
+
+/*
+ * Owns a callback set through the C API and unsets it when destroyed or
+ * reset, unless a newer subscription of the same kind replaced it. As with
+ * the C callbacks, it must not be destroyed while its callback runs in
+ * another thread.
+ */
+class Subscription {
+public:
+	Subscription() {}
+	explicit Subscription(std::unique_ptr<detail::Slot> slot) : slot_(std::move(slot)) {}
+	Subscription(Subscription &&other) : slot_(std::move(other.slot_)) {}
+	Subscription &operator=(Subscription &&other)
+	{
+		if (this != &other) {
+			reset();
+			slot_ = std::move(other.slot_);
+		}
+		return *this;
+	}
+	~Subscription() { reset(); }
+
+	Subscription(const Subscription &) = delete;
+	Subscription &operator=(const Subscription &) = delete;
+
+	/* Whether the callback is still the one set for its kind */
+	bool active() const { return slot_ && slot_->kind.owner.load() == slot_.get(); }
+
+	void reset()
+	{
+		if (!slot_)
+			return;
+		{
+			std::lock_guard<std::mutex> lock(slot_->kind.lock);
+			if (slot_->kind.owner.load() == slot_.get()) {
+				slot_->kind.owner.store(nullptr);
+				slot_->unset();
+			}
+		}
+		slot_.reset();
+	}
+
+private:
+	std::unique_ptr<detail::Slot> slot_;
+};
+
+namespace detail {
+
+/* set(S *) sets the C callback of the slot and returns its error */
+template <typename S, typename Set>
+inline Result<Subscription> subscribe(std::unique_ptr<S> slot, Set set)
+{
+	std::lock_guard<std::mutex> lock(slot->kind.lock);
+	int ret = set(slot.get());
+
+	if (ret != DEVICE_ERROR_NONE)
+		return unexpected(ret);
+	slot->kind.owner.store(slot.get());
+	return Result<Subscription>(Subscription(std::move(slot)));
+}
+
+} // namespace detail
+
+/* Calls f(int percent) on battery charge percentage changes, see device_battery_set_cb() */
+template <typename F>
+inline Result<Subscription> on_battery_changed(F f)
+{
+	std::unique_ptr<detail::BatterySlot<F> > slot(new detail::BatterySlot<F>(std::move(f)));
+
+	return detail::subscribe(std::move(slot), [](detail::BatterySlot<F> *s) {
+		return device_battery_set_cb(&detail::BatterySlot<F>::invoke, s);
+	});
+}
+
+/*
+ * Calls f(device_battery_warn_e status) on battery warnings of the given
+ * levels, see device_battery_warning_set_level_cb()
+ */
+template <typename F>
+inline Result<Subscription> on_battery_warning(F f, unsigned int levels = DEVICE_BATTERY_WARN_MASK_ALL)
+{
+	std::unique_ptr<detail::WarningSlot<F> > slot(new detail::WarningSlot<F>(std::move(f)));
+
+	return detail::subscribe(std::move(slot), [levels](detail::WarningSlot<F> *s) {
+		return device_battery_warning_set_level_cb(levels, &detail::WarningSlot<F>::invoke, s);
+	});
+}
+
+inline Result<int> battery_percent()
+{
+	int percent = 0;
+	int ret = device_battery_get_percent(&percent);
+	return detail::make_result(ret, percent);
+}
+
+inline Result<int> battery_detail()
+{
+	int detail = 0;
+	int ret = device_battery_get_detail(&detail);
+	return detail::make_result(ret, detail);
+}
+
+inline Result<bool> battery_is_charging()
+{
+	bool charging = false;
+	int ret = device_battery_is_charging(&charging);
+	return detail::make_result(ret, charging);
+}
+
+inline Result<bool> battery_is_full()
+{
+	bool full = false;
+	int ret = device_battery_is_full(&full);
+	return detail::make_result(ret, full);
+}
+
+inline Result<device_battery_warn_e> battery_warning_status()
+{
+	device_battery_warn_e status = DEVICE_BATTERY_WARN_NORMAL;
+	int ret = device_battery_get_warning_status(&status);
+	return detail::make_result(ret, status);
+}
+
+inline Result<int> display_count()
+{
+	int count = 0;
+	int ret = device_get_display_numbers(&count);
+	return detail::make_result(ret, count);
+}
+
+inline Result<int> flash_brightness()
+{
+	int value = 0;
+	int ret = device_flash_get_brightness(&value);
+	return detail::make_result(ret, value);
+}
+
+inline Result<void> set_flash_brightness(int value)
+{
+	return detail::make_result(device_flash_set_brightness(value));
+}
+
+inline Result<int> flash_max_brightness()
+{
+	int value = 0;
+	int ret = device_flash_get_max_brightness(&value);
+	return detail::make_result(ret, value);
+}
+
+/*
+ * The display of index N. The index is checked at compile time against
+ * DEVICE_CXX_DISPLAY_MAX, so the brightness calls use the unchecked C
+ * functions that skip the display count query. A display the device does
+ * not have fails with DEVICE_ERROR_OPERATION_FAILED.
+ */
+template <int N>
+class Display {
+	static_assert(N >= 0 && N < DEVICE_CXX_DISPLAY_MAX, "display index out of range");
+
+public:
+	static const int index = N;
+
+	static Result<int> brightness()
+	{
+		int value = 0;
+		int ret = device_get_brightness_unchecked(N, &value);
+		return detail::make_result(ret, value);
+	}
+
+	static Result<void> set_brightness(int value)
+	{
+		return detail::make_result(device_set_brightness_unchecked(N, value));
+	}
+
+	static Result<int> max_brightness()
+	{
+		int value = 0;
+		int ret = device_get_max_brightness(N, &value);
+		return detail::make_result(ret, value);
+	}
+
+	static Result<void> set_brightness_from_settings()
+	{
+		return detail::make_result(device_set_brightness_from_settings(N));
+	}
+
+	static Result<int> brightness_percent()
+	{
+		int percent = 0;
+		int ret = device_get_brightness_percent(N, &percent);
+		return detail::make_result(ret, percent);
+	}
+
+	static Result<void> set_brightness_percent(int percent)
+	{
+		return detail::make_result(device_set_brightness_percent(N, percent));
+	}
+
+	static Result<void> set_brightness_curve(device_brightness_curve_e curve)
+	{
+		return detail::make_result(device_set_brightness_curve(N, curve));
+	}
+};
+
+/* The main display */
+typedef Display<0> MainDisplay;
+
+} // namespace device
+
+#endif  // __TIZEN_SYSTEM_DEVICE_HPP__
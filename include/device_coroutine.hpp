@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+
+#ifndef __TIZEN_SYSTEM_DEVICE_COROUTINE_HPP__
+#define __TIZEN_SYSTEM_DEVICE_COROUTINE_HPP__
+
+/*
+ * C++20 awaitables of the device API, on top of device.hpp.
+ *
+ *     device::Result<int> percent = co_await device::battery_changed(executor);
+ *
+ * An awaiter keeps its whole state in the coroutine frame: event waits
+ * chain their device_waiter_s into the library's list (device_wait_once())
+ * and asynchronous calls hand the awaiter itself to the request queue, so
+ * awaiting allocates nothing and needs no thread of its own.
+ *
+ * The coroutine is resumed through an executor, any object callable with a
+ * std::coroutine_handle<>. It is called in the thread that delivers the
+ * notification or completes the request, and typically posts the handle to
+ * the event loop of the service. InlineExecutor resumes in place.
+ *
+ * A coroutine suspended on an event wait may be destroyed, the wait is then
+ * canceled, or if its notification already reached the executor, the
+ * destruction waits until the executor has been called. Past that point
+ * the executor owns the handle. One suspended on an asynchronous call
+ * must not be destroyed before it resumes, the request cannot be taken
+ * back.
+ */
+
+#if __cplusplus < 202002L
+#error "device_coroutine.hpp needs C++20"
+#endif
+
+#include <coroutine>
+#include <type_traits>
+#include <utility>
+#include <device.hpp>
+
+namespace device {
+
+/* Resumes the coroutine in the thread that completed the wait */
+struct InlineExecutor {
+	void operator()(std::coroutine_handle<> handle) const { handle.resume(); }
+};
+
+namespace detail {
+
+/* Resumes through a copy, the awaiter (and its executor) may be gone once the coroutine runs */
+template <typename Executor>
+inline void resume(Executor &executor, std::coroutine_handle<> handle)
+{
+	Executor ex = std::move(executor);
+	ex(handle);
+}
+
+} // namespace detail
+
+/* Waits for the next notification of a device_wait_e, see device_wait_once() */
+template <typename T, typename Executor>
+class EventAwaiter {
+public:
+	EventAwaiter(device_wait_e event, Executor executor)
+		: event_(event), executor_(std::move(executor)), waiter_(), result_(unexpected(DEVICE_ERROR_OPERATION_FAILED)) {}
+	~EventAwaiter() { device_wait_cancel(&waiter_); }
+
+	EventAwaiter(const EventAwaiter &) = delete;
+	EventAwaiter &operator=(const EventAwaiter &) = delete;
+
+	bool await_ready() const noexcept { return false; }
+
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		int ret;
+
+		handle_ = handle;
+		ret = device_wait_once(event_, &waiter_, &EventAwaiter::done, this);
+		if (ret != DEVICE_ERROR_NONE) {
+			result_ = unexpected(ret);
+			return false;
+		}
+		/* The notification may already be resuming the coroutine, this is not touched any more */
+		return true;
+	}
+
+	Result<T> await_resume() { return std::move(result_); }
+
+private:
+	static void done(int error, int value, void *data)
+	{
+		EventAwaiter *self = static_cast<EventAwaiter *>(data);
+
+		self->result_ = detail::make_result(error, static_cast<T>(value));
+		detail::resume(self->executor_, self->handle_);
+	}
+
+	device_wait_e event_;
+	Executor executor_;
+	device_waiter_s waiter_;
+	std::coroutine_handle<> handle_;
+	Result<T> result_;
+};
+
+/* Completion of an asynchronous brightness request, see device_get_brightness_async() */
+template <typename T, typename Executor>
+class BrightnessAwaiter {
+public:
+	BrightnessAwaiter(int display_index, int value, Executor executor)
+		: display_index_(display_index), value_(value), executor_(std::move(executor)),
+		  result_(unexpected(DEVICE_ERROR_OPERATION_FAILED)) {}
+
+	BrightnessAwaiter(const BrightnessAwaiter &) = delete;
+	BrightnessAwaiter &operator=(const BrightnessAwaiter &) = delete;
+
+	bool await_ready() const noexcept { return false; }
+
+	bool await_suspend(std::coroutine_handle<> handle)
+	{
+		int ret;
+
+		handle_ = handle;
+		if constexpr (std::is_void_v<T>)
+			ret = device_set_brightness_async(display_index_, value_, &BrightnessAwaiter::done, this, nullptr);
+		else
+			ret = device_get_brightness_async(display_index_, &BrightnessAwaiter::done, this, nullptr);
+		if (ret != DEVICE_ERROR_NONE) {
+			result_ = unexpected(ret);
+			return false;
+		}
+		return true;
+	}
+
+	Result<T> await_resume() { return std::move(result_); }
+
+private:
+	static void done(int request_id, int error, int value, void *data)
+	{
+		BrightnessAwaiter *self = static_cast<BrightnessAwaiter *>(data);
+
+		if constexpr (std::is_void_v<T>)
+			self->result_ = detail::make_result(error);
+		else
+			self->result_ = detail::make_result(error, value);
+		detail::resume(self->executor_, self->handle_);
+	}
+
+	int display_index_;
+	int value_;
+	Executor executor_;
+	std::coroutine_handle<> handle_;
+	Result<T> result_;
+};
+
+/* The next battery charge percentage */
+template <typename Executor = InlineExecutor>
+inline EventAwaiter<int, Executor> battery_changed(Executor executor = Executor())
+{
+	return { DEVICE_WAIT_BATTERY_CAPACITY, std::move(executor) };
+}
+
+/* The next charging state, true when charging */
+template <typename Executor = InlineExecutor>
+inline EventAwaiter<bool, Executor> charging_changed(Executor executor = Executor())
+{
+	return { DEVICE_WAIT_BATTERY_CHARGING, std::move(executor) };
+}
+
+/* The next battery warning status */
+template <typename Executor = InlineExecutor>
+inline EventAwaiter<device_battery_warn_e, Executor> battery_warning_changed(Executor executor = Executor())
+{
+	return { DEVICE_WAIT_BATTERY_WARNING, std::move(executor) };
+}
+
+/* The brightness of a display, read by the request queue */
+template <typename Executor = InlineExecutor>
+inline BrightnessAwaiter<int, Executor> get_brightness_async(int display_index, Executor executor = Executor())
+{
+	return { display_index, 0, std::move(executor) };
+}
+
+/* Sets the brightness of a display from the request queue */
+template <typename Executor = InlineExecutor>
+inline BrightnessAwaiter<void, Executor> set_brightness_async(int display_index, int value, Executor executor = Executor())
+{
+	return { display_index, value, std::move(executor) };
+}
+
+} // namespace device
+
+#endif  // __TIZEN_SYSTEM_DEVICE_COROUTINE_HPP__
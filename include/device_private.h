@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+
+#ifndef __TIZEN_SYSTEM_DEVICE_PRIVATE_H__
+#define __TIZEN_SYSTEM_DEVICE_PRIVATE_H__
+
+#include <dlog.h>
+#include <vconf.h>
+#include <device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define _MSG_DEVICE_ERROR_INVALID_PARAMETER "Invalid parameter"
+#define _MSG_DEVICE_ERROR_OPERATION_FAILED "Operation failed"
+#define _MSG_DEVICE_ERROR_NOT_SUPPORTED "Not supported in this device"
+#define _MSG_DEVICE_ERROR_RESOURCE_BUSY "Resource busy"
+#define _MSG_DEVICE_ERROR_TIMED_OUT "Timed out"
+
+#define RETURN_ERR_MSG(err_code, msg) \
+    do { \
+        LOGE("[%s] "_MSG_##err_code"(0x%08x) : %s", __FUNCTION__, err_code, msg); \
+        return err_code; \
+    }while(0)
+
+#define RETURN_ERR(err_code) \
+    do { \
+        LOGE("[%s] "_MSG_##err_code"(0x%08x)", __FUNCTION__, err_code); \
+        return err_code; \
+    }while(0)
+
+/*
+ * The number of displays that devman can address (DEV_DISPLAY_0, DEV_DISPLAY_1).
+ * A single display build (the SINGLE_DISPLAY CMake option) only knows the
+ * main display and never asks the backend for the display count.
+ */
+#ifdef DEVICE_SINGLE_DISPLAY
+#define DEVICE_DISPLAY_MAX 1
+#else
+#define DEVICE_DISPLAY_MAX 2
+#endif
+
+/* DEVICE_PROP_DISPLAY<n>_BRIGHTNESS of a display index */
+#define DEVICE_PROP_DISPLAY_BRIGHTNESS(idx) \
+	(DEVICE_PROP_DISPLAY0_BRIGHTNESS + (idx) * (DEVICE_PROP_DISPLAY1_BRIGHTNESS - DEVICE_PROP_DISPLAY0_BRIGHTNESS))
+
+/* Maximum brightness of a display index, read from the backend once; negative on failure */
+int _device_display_max(int disp_idx);
+
+/* Maximum brightness of the flash LED, read from the backend once; negative on failure */
+int _device_flash_max(void);
+
+/* Records an observed change of a tracked property (see device_changes_since()) */
+void _device_state_update(device_prop_e prop, int value);
+
+/*
+ * Backend operations. The default backend resolves devman and vconf on
+ * first use of each subsystem instead of linking them at load time.
+ * The devman ones return a negative value on failure, the vconf ones
+ * follow the vconf conventions.
+ */
+struct device_backend {
+	const char *name;
+
+	/* display */
+	int (*display_count)(void);
+	int (*display_get_brt)(int disp);
+	int (*display_set_brt)(int disp, int value);
+	int (*display_get_max_brt)(int disp);
+	int (*display_release_brt)(int disp);
+
+	/* battery */
+	int (*battery_get_pct)(void);
+	int (*battery_get_pct_raw)(void);
+	int (*battery_is_full)(void);
+
+	/* camera flash LED */
+	int (*led_get_brt)(void);
+	int (*led_set_brt)(int value);
+	int (*led_get_max)(void);
+
+	/* vconf */
+	int (*vconf_get_int)(const char *key, int *value);
+	int (*vconf_notify)(const char *key, vconf_callback_fn cb, void *data);
+	int (*vconf_ignore)(const char *key, vconf_callback_fn cb);
+	int (*keynode_get_int)(const keynode_t *key);
+};
+
+/* The backend selected by CAPI_SYSTEM_DEVICE_BACKEND, devman by default */
+const struct device_backend *_device_backend(void);
+
+#define BACKEND() _device_backend()
+
+/*
+ * Kernel trace markers, enabled with CAPI_SYSTEM_DEVICE_FTRACE=1.
+ * When disabled each marker costs one predicted branch.
+ */
+extern int _device_ftrace_fd;
+void _device_ftrace(char type, const char *fmt, ...)
+		__attribute__((format(printf, 2, 3)));
+
+#define FTRACE_ENABLED() __builtin_expect(__atomic_load_n(&_device_ftrace_fd, __ATOMIC_RELAXED) >= 0, 0)
+
+#define FTRACE_BEGIN(fmt, ...) \
+	do { \
+		if (FTRACE_ENABLED()) \
+			_device_ftrace('B', "%s " fmt, __FUNCTION__, ##__VA_ARGS__); \
+	} while (0)
+
+#define FTRACE_END(ret, fmt, ...) \
+	do { \
+		if (FTRACE_ENABLED()) \
+			_device_ftrace('E', "%s ret=%d " fmt, __FUNCTION__, ret, ##__VA_ARGS__); \
+	} while (0)
+
+/* Monotonic clock in microseconds */
+unsigned long long _device_now_us(void);
+
+/* Accounts one delivery of a callback (see device_callback_get_stats()) */
+void _device_callback_delivered(device_callback_e callback, unsigned long long stamp,
+		unsigned long long entry, unsigned long long exit);
+void _device_callback_dropped(device_callback_e callback);
+void _device_callback_queued(device_callback_e callback, unsigned int depth);
+void _device_callback_overflow(device_callback_e callback);
+void _device_callback_coalesced(device_callback_e callback, unsigned int count);
+
+/*
+ * Hands a notification to the executor of a callback (see device_callback_set_executor()),
+ * which ends up calling _device_callback_invoke() in the chosen context
+ */
+void _device_executor_submit(device_callback_e callback, int value, unsigned long long stamp);
+void _device_callback_invoke(device_callback_e callback, int value, unsigned long long stamp);
+
+/* Events multiplexed by the internal vconf dispatcher */
+typedef enum {
+	DEVICE_EVENT_BATTERY_CAPACITY,	/* VCONFKEY_SYSMAN_BATTERY_CAPACITY */
+	DEVICE_EVENT_BATTERY_CHARGING,	/* VCONFKEY_SYSMAN_BATTERY_CHARGE_NOW */
+	DEVICE_EVENT_BATTERY_WARNING,	/* VCONFKEY_SYSMAN_BATTERY_STATUS_LOW */
+	DEVICE_EVENT_MAX,
+} device_event_e;
+
+/*
+ * Called with the raw integer value of the vconf key and the time
+ * (_device_now_us()) the notification reached the library
+ */
+typedef void (*device_event_handler)(device_event_e event, int value, unsigned long long stamp, void *data);
+
+int _device_event_subscribe(device_event_e event, device_event_handler handler, void *data);
+int _device_event_unsubscribe(device_event_e event, device_event_handler handler, void *data);
+void _device_event_dispatch(device_event_e event, int value, unsigned long long stamp);
+
+/* Returns the event of a vconf key, or -1 (not meant for the notification path) */
+int _device_event_from_key(const char *key);
+
+/* Trace recording and replay, see src/device_record.c */
+const struct device_backend *_device_record_backend(const struct device_backend *inner, const char *path);
+const struct device_backend *_device_replay_backend(const char *path);
+void _device_record_event(device_event_e event, int value);
+
+/* Parses a comma separated list of name=value options of a backend configuration */
+struct device_backend_option {
+	const char *name;
+	int *value;
+};
+
+void _device_backend_options(const char *conf, const struct device_backend_option *options, int count);
+
+/* Simulated device, see src/device_sim.c */
+const struct device_backend *_device_sim_backend(void);
+
+/* Mock device with fault injection, see src/device_mock.c */
+const struct device_backend *_device_mock_backend(void);
+
+/*
+ * Call deadlines, see src/device_timeout.c. A public call brackets its
+ * work with _device_call_begin() and _device_call_end(), which arm a
+ * deadline for the backend calls the thread makes in between; nested
+ * public calls share the outermost deadline. _device_call_end() turns
+ * the result into DEVICE_ERROR_TIMED_OUT if a backend call timed out.
+ */
+const struct device_backend *_device_timeout_backend(const struct device_backend *inner);
+/* The absolute deadline of a call made now by this thread, 0 for none */
+unsigned long long _device_call_deadline(void);
+void _device_call_begin(void);
+void _device_call_begin_at(unsigned long long deadline);
+int _device_call_end(int ret);
+/* The deadline armed for the calling thread, 0 for none, and whether a backend call of it timed out */
+unsigned long long _device_call_armed(void);
+int _device_call_timed_out(void);
+
+/* Retries and circuit breakers of the backend calls, see src/device_retry.c */
+const struct device_backend *_device_retry_backend(const struct device_backend *inner);
+/* Nested, backend calls of the calling thread fail on their first error in between */
+void _device_retry_suspend(void);
+void _device_retry_resume(void);
+
+/*
+ * Shared scheduler of periodic work, see src/device_sched.c.
+ * func runs on the scheduler thread and returns its next deadline
+ * (_device_now_us() time base), or 0 to stop. Tasks live in static storage.
+ */
+struct device_sched_task {
+	unsigned long long (*func)(struct device_sched_task *task, unsigned long long now);
+	void *data;
+	unsigned long long period;		/* used by _device_sched_backoff() */
+	unsigned long long period_min;
+	unsigned long long period_max;
+
+	/* owned by the scheduler */
+	unsigned long long deadline;
+	int index;
+	int active;
+	int running;
+};
+
+/* Schedules a task, or moves the deadline of a scheduled one; returns 0 or -1 */
+int _device_sched_add(struct device_sched_task *task, unsigned long long deadline);
+void _device_sched_cancel(struct device_sched_task *task);
+/* Next deadline of a polling task: period_min after a change, doubling up to period_max while stable */
+unsigned long long _device_sched_backoff(struct device_sched_task *task, int changed, unsigned long long now);
+
+/* Delivers a batch (see src/device_batch.c), changes is a mask of device_change_e */
+void _device_batch_invoke(unsigned int changes, unsigned long long stamp);
+
+/* Delivers a sampled detail charge (see src/device_detail.c) */
+void _device_detail_invoke(int detail, unsigned long long stamp);
+
+/*
+ * Accounts a brightness write of a display made outside the leases (see
+ * src/device_lease.c), so the next lease change writes its winner again
+ */
+void _device_lease_invalidate(int disp_idx);
+
+/* Maps a VCONFKEY_SYSMAN_BATTERY_STATUS_LOW value, returns -1 if unknown */
+int _device_battery_warn_status(int value, device_battery_warn_e *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __TIZEN_SYSTEM_DEVICE_PRIVATE_H__
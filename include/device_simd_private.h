@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+
+#ifndef __TIZEN_SYSTEM_DEVICE_SIMD_PRIVATE_H__
+#define __TIZEN_SYSTEM_DEVICE_SIMD_PRIVATE_H__
+
+/*
+ * Aggregation kernels over the columns of a battery series, see
+ * src/device_simd.c. This header has no dependency on the rest of the
+ * library, so the kernels can be built and benchmarked on their own.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sums over a window, x is the time in ms since t0 and y the value */
+struct device_moments {
+	double sx;
+	double sxx;
+	double sy;
+	double syy;
+	double sxy;
+};
+
+struct device_kernels {
+	const char *name;
+	/* n > 0 */
+	void (*minmax)(const int32_t *v, int n, int32_t *min, int32_t *max);
+	/* the times of the window must lie within 2^51 ms of t0 */
+	void (*moments)(const int64_t *t, const int32_t *v, int n, int64_t t0, struct device_moments *m);
+};
+
+/* The kernels built for this target, scalar first, NULL terminated */
+extern const struct device_kernels *const _device_kernels_all[];
+
+/* The fastest kernels the running CPU supports */
+const struct device_kernels *_device_kernels(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __TIZEN_SYSTEM_DEVICE_SIMD_PRIVATE_H__
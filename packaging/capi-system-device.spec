@@ -11,6 +11,13 @@ BuildRequires:  pkgconfig(devman)
 BuildRequires:  pkgconfig(capi-base-common)
 BuildRequires:  pkgconfig(dlog)
 BuildRequires:  pkgconfig(vconf)
+# devman and vconf are dlopen()ed, so rpm cannot find these by itself
+Requires:   devman
+Requires:   vconf
+
+# build with --with single_display for products that only have the main display,
+# its pkg-config file then defines DEVICE_SINGLE_DISPLAY for the users of the headers
+%bcond_with single_display
 
 Requires(post): /sbin/ldconfig  
 Requires(postun): /sbin/ldconfig
@@ -33,7 +40,7 @@ Requires: %{name} = %{version}-%{release}
 
 %build
 MAJORVER=`echo %{version} | awk 'BEGIN {FS="."}{print $1}'`
-cmake . -DCMAKE_INSTALL_PREFIX=/usr -DFULLVER=%{version} -DMAJORVER=${MAJORVER}
+cmake . -DCMAKE_INSTALL_PREFIX=/usr -DFULLVER=%{version} -DMAJORVER=${MAJORVER} %{?with_single_display:-DSINGLE_DISPLAY=ON}
 
 make %{?jobs:-j%jobs}
 
@@ -51,6 +58,8 @@ rm -rf %{buildroot}
 
 %files devel
 %{_includedir}/system/device.h
+%{_includedir}/system/device.hpp
+%{_includedir}/system/device_coroutine.hpp
 %{_libdir}/pkgconfig/*.pc
 %{_libdir}/libcapi-system-device.so
 
@@ -18,67 +18,124 @@
 
 #define LOG_TAG "TIZEN_SYSTEM_DEVICE"
 
-#include <string.h>
 #include <stdio.h>
 #include <devman.h>
 #include <device.h>
 #include <errno.h>
+#include <pthread.h>
 #include <dlog.h>
 #include <vconf.h>
+#include <device_private.h>
 
-#define _MSG_DEVICE_ERROR_INVALID_PARAMETER "Invalid parameter"
-#define _MSG_DEVICE_ERROR_OPERATION_FAILED "Operation failed"
-#define _MSG_DEVICE_ERROR_NOT_SUPPORTED "Not supported in this device"
 
-#define RETURN_ERR_MSG(err_code, msg) \
-    do { \
-        LOGE("[%s] "_MSG_##err_code"(0x%08x) : %s", __FUNCTION__, err_code, msg); \
-        return err_code; \
-    }while(0)
-
-#define RETURN_ERR(err_code) \
-    do { \
-        LOGE("[%s] "_MSG_##err_code"(0x%08x)", __FUNCTION__, err_code); \
-        return err_code; \
-    }while(0)
-
-static int _display[] = {
+#ifdef DEVICE_SINGLE_DISPLAY
+/* The topology is fixed at build time, so index checks against the count fold to constants */
+#define DISPLAY_ID(idx) DEV_DISPLAY_0
+#define DISPLAY_COUNT() DEVICE_DISPLAY_MAX
+#else
+static int _display[DEVICE_DISPLAY_MAX] = {
     DEV_DISPLAY_0,
     DEV_DISPLAY_1,
 };
 
-int device_get_display_numbers(int* device_number)
+#define DISPLAY_ID(idx) _display[idx]
+#define DISPLAY_COUNT() BACKEND()->display_count()
+#endif
+
+/* Maximum brightness of each display index, 0 until first read. It is a panel property, so it never changes */
+static int _max_brt[DEVICE_DISPLAY_MAX];
+
+int _device_display_max(int disp_idx)
+{
+	int val;
+
+	if(disp_idx < 0 || disp_idx >= DEVICE_DISPLAY_MAX)
+		return -1;
+
+	val = __atomic_load_n(&_max_brt[disp_idx], __ATOMIC_RELAXED);
+	if(val > 0)
+		return val;
+
+	val = BACKEND()->display_get_max_brt(DISPLAY_ID(disp_idx));
+	if(val > 0)
+		__atomic_store_n(&_max_brt[disp_idx], val, __ATOMIC_RELAXED);
+	return val;
+}
+
+/* Likewise for the flash LED */
+static int _max_led;
+
+int _device_flash_max(void)
+{
+	int val;
+
+	val = __atomic_load_n(&_max_led, __ATOMIC_RELAXED);
+	if(val > 0)
+		return val;
+
+	val = BACKEND()->led_get_max();
+	if(val > 0)
+		__atomic_store_n(&_max_led, val, __ATOMIC_RELAXED);
+	return val;
+}
+
+static int _device_get_display_numbers(int* device_number)
 {
     if(device_number == NULL)
         RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-    *device_number = device_get_display_count();
+    *device_number = DISPLAY_COUNT();
     if(*device_number < 0)
         RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 
     return DEVICE_ERROR_NONE;
 }
 
-int device_battery_get_percent(int* percent)
+int device_get_display_numbers(int* device_number)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_get_display_numbers(device_number));
+	FTRACE_END(ret, "count=%d", ret == DEVICE_ERROR_NONE ? *device_number : -1);
+
+	return ret;
+}
+
+static int _device_battery_get_percent(int* percent)
 {
 	if (percent == NULL)
 		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-	int pct = device_get_battery_pct();
+	int pct = BACKEND()->battery_get_pct();
 	if (pct < 0) {
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 	} else {
 		*percent = pct;
 	}
+	_device_state_update(DEVICE_PROP_BATTERY_PERCENT, pct);
 	return DEVICE_ERROR_NONE;
 }
 
-int device_battery_get_detail(int* percent)
+int device_battery_get_percent(int* percent)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_get_percent(percent));
+	FTRACE_END(ret, "percent=%d", ret == DEVICE_ERROR_NONE ? *percent : -1);
+
+	return ret;
+}
+
+static int _device_battery_get_detail(int* percent)
 {
 	if (percent == NULL)
 		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-	int pct = device_get_battery_pct_raw();
+	int pct = BACKEND()->battery_get_pct_raw();
 	if (pct == -ENODEV)
 		RETURN_ERR(DEVICE_ERROR_NOT_SUPPORTED);
 
@@ -89,12 +146,24 @@ int device_battery_get_detail(int* percent)
 	return DEVICE_ERROR_NONE;
 }
 
-int device_battery_is_full(bool* full)
+int device_battery_get_detail(int* percent)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_get_detail(percent));
+	FTRACE_END(ret, "detail=%d", ret == DEVICE_ERROR_NONE ? *percent : -1);
+
+	return ret;
+}
+
+static int _device_battery_is_full(bool* full)
 {
 	if (full == NULL)
 		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-	int f = device_is_battery_full();
+	int f = BACKEND()->battery_is_full();
 	if (f < 0) {
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 	} else {
@@ -103,78 +172,170 @@ int device_battery_is_full(bool* full)
 	return DEVICE_ERROR_NONE;
 }
 
-int device_get_brightness(int disp_idx, int* value)
+int device_battery_is_full(bool* full)
 {
-	int val, disp, max_id;
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_is_full(full));
+	FTRACE_END(ret, "full=%d", ret == DEVICE_ERROR_NONE ? *full : -1);
+
+	return ret;
+}
+
+/* The backend part of device_get_brightness(), for an index already checked */
+static int _device_read_brightness(int disp_idx, int* value)
+{
+	int val;
+
+	val = BACKEND()->display_get_brt(DISPLAY_ID(disp_idx));
+	if(val < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	*value = val;
+	_device_state_update(DEVICE_PROP_DISPLAY_BRIGHTNESS(disp_idx), val);
+	return DEVICE_ERROR_NONE;
+}
+
+static int _device_get_brightness(int disp_idx, int* value)
+{
+	int max_id;
 
     if(value == NULL) RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-    if(device_get_display_numbers(&max_id) < 0)
+    if(_device_get_display_numbers(&max_id) < 0)
         RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 
     if(disp_idx < 0 || disp_idx >= max_id)
         RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-    disp = _display[disp_idx];
+    return _device_read_brightness(disp_idx, value);
+}
 
-    if(value == NULL)
-        RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+int device_get_brightness(int disp_idx, int* value)
+{
+	int ret;
 
-	val = device_get_display_brt(disp);
-	
-	if(val < 0) {
-        RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
-    }
-	else
-		*value = val;
+	FTRACE_BEGIN("disp=%d", disp_idx);
+	_device_call_begin();
+	ret = _device_call_end(_device_get_brightness(disp_idx, value));
+	FTRACE_END(ret, "disp=%d value=%d", disp_idx, ret == DEVICE_ERROR_NONE ? *value : -1);
+
+	return ret;
+}
 
+/* The value check and backend part of device_set_brightness(), for an index already checked */
+static int _device_write_brightness(int disp_idx, int new_value)
+{
+	int max_value, ret;
+
+	if(new_value < 0)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	max_value = _device_display_max(disp_idx);
+	if(max_value < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	if(new_value > max_value)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	/* Counted even when it fails, the panel may have taken it anyway */
+	ret = BACKEND()->display_set_brt(DISPLAY_ID(disp_idx), new_value);
+	_device_lease_invalidate(disp_idx);
+	if(ret < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	_device_state_update(DEVICE_PROP_DISPLAY_BRIGHTNESS(disp_idx), new_value);
 	return DEVICE_ERROR_NONE;
 }
 
-int device_set_brightness(int disp_idx, int new_value)
+static int _device_set_brightness(int disp_idx, int new_value)
 {
-    int max_value, val;
-	int disp, max_id;
+	int max_id;
     
-    if(device_get_display_numbers(&max_id) < 0)
+    if(_device_get_display_numbers(&max_id) < 0)
         RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 
     if(disp_idx < 0 || disp_idx >= max_id)
         RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-    disp = _display[disp_idx];
+    return _device_write_brightness(disp_idx, new_value);
+}
 
-    if(new_value < 0)
-        RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+int device_set_brightness(int disp_idx, int new_value)
+{
+	int ret;
 
-    device_get_max_brightness(disp, &max_value);
+	FTRACE_BEGIN("disp=%d value=%d", disp_idx, new_value);
+	_device_call_begin();
+	ret = _device_call_end(_device_set_brightness(disp_idx, new_value));
+	FTRACE_END(ret, "disp=%d", disp_idx);
 
-    if(new_value > max_value)
-        RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+	return ret;
+}
 
-	val = device_set_display_brt(disp, new_value);
-	if(val < 0) {
-        RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
-    }
-	return DEVICE_ERROR_NONE;
+/*
+ * The unchecked variants skip the display count query, the index is only
+ * bounded by the displays devman can address. An index the device does
+ * not have fails in the backend.
+ */
+static int _device_get_brightness_unchecked(int disp_idx, int* value)
+{
+	if(disp_idx < 0 || disp_idx >= DEVICE_DISPLAY_MAX || value == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	return _device_read_brightness(disp_idx, value);
 }
 
-int device_get_max_brightness(int disp_idx, int* max_value)
+int device_get_brightness_unchecked(int disp_idx, int* value)
+{
+	int ret;
+
+	FTRACE_BEGIN("disp=%d", disp_idx);
+	_device_call_begin();
+	ret = _device_call_end(_device_get_brightness_unchecked(disp_idx, value));
+	FTRACE_END(ret, "disp=%d value=%d", disp_idx, ret == DEVICE_ERROR_NONE ? *value : -1);
+
+	return ret;
+}
+
+static int _device_set_brightness_unchecked(int disp_idx, int new_value)
+{
+	if(disp_idx < 0 || disp_idx >= DEVICE_DISPLAY_MAX)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	return _device_write_brightness(disp_idx, new_value);
+}
+
+int device_set_brightness_unchecked(int disp_idx, int new_value)
+{
+	int ret;
+
+	FTRACE_BEGIN("disp=%d value=%d", disp_idx, new_value);
+	_device_call_begin();
+	ret = _device_call_end(_device_set_brightness_unchecked(disp_idx, new_value));
+	FTRACE_END(ret, "disp=%d", disp_idx);
+
+	return ret;
+}
+
+static int _device_get_max_brightness(int disp_idx, int* max_value)
 {
 	int val, disp, max_id;
     
-    if(device_get_display_numbers(&max_id) < 0)
+    if(_device_get_display_numbers(&max_id) < 0)
         RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 
     if(disp_idx < 0 || disp_idx >= max_id)
         RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 	
-    disp = _display[disp_idx];
+    disp = DISPLAY_ID(disp_idx);
 
     if(max_value == NULL)
         RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-	val = device_get_max_brt(disp);
+	val = BACKEND()->display_get_max_brt(disp);
 	
 	if(val < 0) {
         RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
@@ -185,19 +346,32 @@ int device_get_max_brightness(int disp_idx, int* max_value)
 	return DEVICE_ERROR_NONE;
 }
 
-int device_set_brightness_from_settings(int disp_idx)
+int device_get_max_brightness(int disp_idx, int* max_value)
+{
+	int ret;
+
+	FTRACE_BEGIN("disp=%d", disp_idx);
+	_device_call_begin();
+	ret = _device_call_end(_device_get_max_brightness(disp_idx, max_value));
+	FTRACE_END(ret, "disp=%d max=%d", disp_idx, ret == DEVICE_ERROR_NONE ? *max_value : -1);
+
+	return ret;
+}
+
+static int _device_set_brightness_from_settings(int disp_idx)
 {
 	int max_id, disp, val;
 
-	if(device_get_display_numbers(&max_id) < 0)
+	if(_device_get_display_numbers(&max_id) < 0)
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 
 	if(disp_idx < 0 || disp_idx >= max_id)
 		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-	disp = _display[disp_idx];
+	disp = DISPLAY_ID(disp_idx);
 
-	val = device_release_brt_ctrl(disp);
+	val = BACKEND()->display_release_brt(disp);
+	_device_lease_invalidate(disp_idx);
 	if(val < 0) {
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 	}
@@ -205,7 +379,19 @@ int device_set_brightness_from_settings(int disp_idx)
 	return DEVICE_ERROR_NONE;
 }
 
-int device_battery_is_charging(bool *charging)
+int device_set_brightness_from_settings(int disp_idx)
+{
+	int ret;
+
+	FTRACE_BEGIN("disp=%d", disp_idx);
+	_device_call_begin();
+	ret = _device_call_end(_device_set_brightness_from_settings(disp_idx));
+	FTRACE_END(ret, "disp=%d", disp_idx);
+
+	return ret;
+}
+
+static int _device_battery_is_charging(bool *charging)
 {
     // VCONFKEY_SYSMAN_BATTERY_CHARGE_NOW
     int value, err;
@@ -214,7 +400,7 @@ int device_battery_is_charging(bool *charging)
         RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
     }
 
-    err  = vconf_get_int(VCONFKEY_SYSMAN_BATTERY_CHARGE_NOW, &value);
+    err  = BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_CHARGE_NOW, &value);
 
     if(err <0){
         RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
@@ -226,25 +412,46 @@ int device_battery_is_charging(bool *charging)
     }else{
         RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
     }
+    _device_state_update(DEVICE_PROP_BATTERY_CHARGING, value);
     return DEVICE_ERROR_NONE;
 }
 
+int device_battery_is_charging(bool *charging)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_is_charging(charging));
+	FTRACE_END(ret, "charging=%d", ret == DEVICE_ERROR_NONE ? *charging : -1);
+
+	return ret;
+}
+
 static device_battery_cb changed_callback = NULL;
 static void* changed_callback_user_data = NULL;
 
-static void battery_changed_inside_cb(keynode_t* key, void* user_data)
+static void battery_changed_inside_cb(device_event_e event, int percent, unsigned long long stamp, void* user_data)
+{
+    _device_executor_submit(DEVICE_CALLBACK_BATTERY, percent, stamp);
+}
+
+static void battery_changed_invoke(int percent, unsigned long long stamp)
 {
-    char* keyname = vconf_keynode_get_name(key);
+    device_battery_cb callback = changed_callback;
+    unsigned long long entry;
 
-    if(keyname != NULL && changed_callback != NULL && strcmp(keyname, VCONFKEY_SYSMAN_BATTERY_CAPACITY) == 0){
-        int percent = 0;
-        if(vconf_get_int(VCONFKEY_SYSMAN_BATTERY_CAPACITY, &percent) == 0){
-            changed_callback(percent, changed_callback_user_data);
-        }
+    if(callback == NULL){
+        _device_callback_dropped(DEVICE_CALLBACK_BATTERY);
+        return;
     }
+
+    entry = _device_now_us();
+    callback(percent, changed_callback_user_data);
+    _device_callback_delivered(DEVICE_CALLBACK_BATTERY, stamp, entry, _device_now_us());
 }
 
-int device_battery_set_cb(device_battery_cb callback, void* user_data)
+static int _device_battery_set_cb(device_battery_cb callback, void* user_data)
 {
     // VCONFKEY_SYSMAN_BATTERY_CAPACITY
     int err;
@@ -254,16 +461,28 @@ int device_battery_set_cb(device_battery_cb callback, void* user_data)
     changed_callback = callback;
     changed_callback_user_data = user_data;
 
-    err = vconf_notify_key_changed(VCONFKEY_SYSMAN_BATTERY_CAPACITY, battery_changed_inside_cb, NULL);
+    err = _device_event_subscribe(DEVICE_EVENT_BATTERY_CAPACITY, battery_changed_inside_cb, NULL);
     if(err < 0){
         RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
     }
 
     return DEVICE_ERROR_NONE;
 }
-int device_battery_unset_cb(void)
+
+int device_battery_set_cb(device_battery_cb callback, void* user_data)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_set_cb(callback, user_data));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+static int _device_battery_unset_cb(void)
 {
-    int err = vconf_ignore_key_changed(VCONFKEY_SYSMAN_BATTERY_CAPACITY, battery_changed_inside_cb);
+    int err = _device_event_unsubscribe(DEVICE_EVENT_BATTERY_CAPACITY, battery_changed_inside_cb, NULL);
     if(err < 0){
         RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
     }
@@ -273,59 +492,134 @@ int device_battery_unset_cb(void)
     return DEVICE_ERROR_NONE;
 }
 
-int device_battery_get_warning_status(device_battery_warn_e *status)
+int device_battery_unset_cb(void)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_unset_cb());
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+/* VCONFKEY_SYSMAN_BATTERY_STATUS_LOW values to device_battery_warn_e, -1 for unknown values */
+static const signed char _warn_status[] = {
+	[0 ... VCONFKEY_SYSMAN_BAT_FULL] = -1,
+	[VCONFKEY_SYSMAN_BAT_POWER_OFF] = DEVICE_BATTERY_WARN_EMPTY,
+	[VCONFKEY_SYSMAN_BAT_CRITICAL_LOW] = DEVICE_BATTERY_WARN_CRITICAL,
+	[VCONFKEY_SYSMAN_BAT_WARNING_LOW] = DEVICE_BATTERY_WARN_LOW,
+	[VCONFKEY_SYSMAN_BAT_NORMAL] = DEVICE_BATTERY_WARN_NORMAL,
+	[VCONFKEY_SYSMAN_BAT_FULL] = DEVICE_BATTERY_WARN_FULL,
+};
+
+int _device_battery_warn_status(int value, device_battery_warn_e *status)
+{
+	if(value < 0 || value >= (int)(sizeof(_warn_status) / sizeof(_warn_status[0])) || _warn_status[value] < 0)
+		return -1;
+
+	*status = _warn_status[value];
+	return 0;
+}
+
+static int _device_battery_get_warning_status(device_battery_warn_e *status)
 {
 	if (status == NULL) RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
 	int value, err;
 
-	err = vconf_get_int(VCONFKEY_SYSMAN_BATTERY_STATUS_LOW, &value);
+	err = BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_STATUS_LOW, &value);
 
 	if(err < 0){
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 	}
-	if(value == VCONFKEY_SYSMAN_BAT_POWER_OFF){
-		*status = DEVICE_BATTERY_WARN_EMPTY;
-	}else if(value == VCONFKEY_SYSMAN_BAT_CRITICAL_LOW){
-		*status = DEVICE_BATTERY_WARN_CRITICAL;
-	}else if(value == VCONFKEY_SYSMAN_BAT_WARNING_LOW){
-		*status = DEVICE_BATTERY_WARN_LOW;
-	}else if(value == VCONFKEY_SYSMAN_BAT_NORMAL){
-		*status = DEVICE_BATTERY_WARN_NORMAL;
-	}else if(value == VCONFKEY_SYSMAN_BAT_FULL){
-		*status = DEVICE_BATTERY_WARN_FULL;
-	}else{
+	if(_device_battery_warn_status(value, status) < 0){
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 	}
+	_device_state_update(DEVICE_PROP_BATTERY_WARNING, *status);
 	return DEVICE_ERROR_NONE;
 }
 
+int device_battery_get_warning_status(device_battery_warn_e *status)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_get_warning_status(status));
+	FTRACE_END(ret, "status=%d", ret == DEVICE_ERROR_NONE ? (int)*status : -1);
+
+	return ret;
+}
+
 static device_battery_warn_cb warn_changed_callback = NULL;
 static void* warn_changed_callback_user_data = NULL;
+static unsigned int warn_changed_levels = DEVICE_BATTERY_WARN_MASK_ALL;
 
-static void battery_warn_changed_inside_cb(keynode_t* key, void* user_data)
+static void battery_warn_changed_inside_cb(device_event_e event, int bat_state, unsigned long long stamp, void* user_data)
 {
-	char* keyname = vconf_keynode_get_name(key);
+	device_battery_warn_e status;
 
-	if(keyname != NULL && warn_changed_callback != NULL && strcmp(keyname, VCONFKEY_SYSMAN_BATTERY_STATUS_LOW) == 0){
-		int bat_state = 0;
-		if(vconf_get_int(VCONFKEY_SYSMAN_BATTERY_STATUS_LOW, &bat_state) == 0){
-			warn_changed_callback(bat_state-1, warn_changed_callback_user_data);
-		}
+	if(_device_battery_warn_status(bat_state, &status) < 0){
+		LOGE("[%s] unknown battery status %d", __FUNCTION__, bat_state);
+		return;
 	}
+
+	/* Filter before the executor, so an uninterested subscriber is never scheduled */
+	if(!(warn_changed_levels & DEVICE_BATTERY_WARN_MASK(status)))
+		return;
+
+	_device_executor_submit(DEVICE_CALLBACK_BATTERY_WARNING, status, stamp);
 }
 
-int device_battery_warning_set_cb(device_battery_warn_cb callback, void* user_data)
+static void battery_warn_changed_invoke(device_battery_warn_e status, unsigned long long stamp)
+{
+	device_battery_warn_cb callback = warn_changed_callback;
+	unsigned long long entry;
+
+	if(callback == NULL){
+		_device_callback_dropped(DEVICE_CALLBACK_BATTERY_WARNING);
+		return;
+	}
+
+	entry = _device_now_us();
+	callback(status, warn_changed_callback_user_data);
+	_device_callback_delivered(DEVICE_CALLBACK_BATTERY_WARNING, stamp, entry, _device_now_us());
+}
+
+void _device_callback_invoke(device_callback_e callback, int value, unsigned long long stamp)
+{
+	switch(callback){
+	case DEVICE_CALLBACK_BATTERY:
+		battery_changed_invoke(value, stamp);
+		break;
+	case DEVICE_CALLBACK_BATTERY_WARNING:
+		battery_warn_changed_invoke(value, stamp);
+		break;
+	case DEVICE_CALLBACK_BATTERY_BATCH:
+		_device_batch_invoke(value, stamp);
+		break;
+	case DEVICE_CALLBACK_BATTERY_DETAIL:
+		_device_detail_invoke(value, stamp);
+		break;
+	default:
+		break;
+	}
+}
+
+static int _device_battery_warning_set_level_cb(unsigned int levels, device_battery_warn_cb callback, void* user_data)
 {
 	// VCONFKEY_SYSMAN_BATTERY_STATUS_LOW
 	int err;
-	if(callback == NULL)
+	if(callback == NULL || levels == 0 || (levels & ~DEVICE_BATTERY_WARN_MASK_ALL))
 		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
 	warn_changed_callback = callback;
 	warn_changed_callback_user_data = user_data;
+	warn_changed_levels = levels;
 
-	err = vconf_notify_key_changed(VCONFKEY_SYSMAN_BATTERY_STATUS_LOW, battery_warn_changed_inside_cb, NULL);
+	err = _device_event_subscribe(DEVICE_EVENT_BATTERY_WARNING, battery_warn_changed_inside_cb, NULL);
 	if(err < 0){
 		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 	}
@@ -333,60 +627,126 @@ int device_battery_warning_set_cb(device_battery_warn_cb callback, void* user_da
 	return DEVICE_ERROR_NONE;
 }
 
-int device_battery_warning_unset_cb(void)
+int device_battery_warning_set_cb(device_battery_warn_cb callback, void* user_data)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_warning_set_level_cb(DEVICE_BATTERY_WARN_MASK_ALL, callback, user_data));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+int device_battery_warning_set_level_cb(unsigned int levels, device_battery_warn_cb callback, void* user_data)
+{
+	int ret;
+
+	FTRACE_BEGIN("levels=0x%x", levels);
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_warning_set_level_cb(levels, callback, user_data));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+static int _device_battery_warning_unset_cb(void)
 {
-	int err = vconf_ignore_key_changed(VCONFKEY_SYSMAN_BATTERY_STATUS_LOW, battery_warn_changed_inside_cb);
+	int err = _device_event_unsubscribe(DEVICE_EVENT_BATTERY_WARNING, battery_warn_changed_inside_cb, NULL);
 	if(err < 0){
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 	}
 	warn_changed_callback = NULL;
 	warn_changed_callback_user_data = NULL;
+	warn_changed_levels = DEVICE_BATTERY_WARN_MASK_ALL;
 
 	return DEVICE_ERROR_NONE;
 }
 
-int device_flash_get_brightness(int *brightness)
+int device_battery_warning_unset_cb(void)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_warning_unset_cb());
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+static int _device_flash_get_brightness(int *brightness)
 {
 	int value;
 
 	if (brightness == NULL)
 		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-	value = device_get_led_brt();
+	value = BACKEND()->led_get_brt();
 
 	if (value < 0)
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 
 	*brightness = value;
 
+	_device_state_update(DEVICE_PROP_FLASH_BRIGHTNESS, value);
 	return DEVICE_ERROR_NONE;
 }
 
-int device_flash_set_brightness(int brightness)
+int device_flash_get_brightness(int *brightness)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_flash_get_brightness(brightness));
+	FTRACE_END(ret, "value=%d", ret == DEVICE_ERROR_NONE ? *brightness : -1);
+
+	return ret;
+}
+
+static int _device_flash_set_brightness(int brightness)
 {
 	int max_value, value;
 
-	device_flash_get_max_brightness(&max_value);
+	max_value = _device_flash_max();
+	if (max_value < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 
 	if (brightness < 0 || brightness > max_value)
 		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-	value = device_set_led_brt(brightness);
+	value = BACKEND()->led_set_brt(brightness);
 
 	if (value < 0)
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
 
+	_device_state_update(DEVICE_PROP_FLASH_BRIGHTNESS, brightness);
+
 	return DEVICE_ERROR_NONE;
 }
 
-int device_flash_get_max_brightness(int *max_brightness)
+int device_flash_set_brightness(int brightness)
+{
+	int ret;
+
+	FTRACE_BEGIN("value=%d", brightness);
+	_device_call_begin();
+	ret = _device_call_end(_device_flash_set_brightness(brightness));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+static int _device_flash_get_max_brightness(int *max_brightness)
 {
 	int value;
 
 	if (max_brightness == NULL)
 		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
 
-	value = device_get_max_led();
+	value = BACKEND()->led_get_max();
 
 	if (value < 0)
 		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
@@ -395,3 +755,275 @@ int device_flash_get_max_brightness(int *max_brightness)
 
 	return DEVICE_ERROR_NONE;
 }
+
+int device_flash_get_max_brightness(int *max_brightness)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_flash_get_max_brightness(max_brightness));
+	FTRACE_END(ret, "max=%d", ret == DEVICE_ERROR_NONE ? *max_brightness : -1);
+
+	return ret;
+}
+
+/* One step of a scene: the display index, or DEVICE_DISPLAY_MAX for the flash LED */
+struct scene_step {
+	int target;
+	int value;
+	int old;
+};
+
+/*
+ * Scenes read, write and roll back under one lock, so that two of them
+ * never interleave and a roll back never restores a value another scene
+ * read as current. Writes of a display bump its lease write count (see
+ * scene_write()), the next lease change then puts the winner back.
+ */
+static pthread_mutex_t _scene_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int scene_read(int target)
+{
+	if(target == DEVICE_DISPLAY_MAX)
+		return BACKEND()->led_get_brt();
+	return BACKEND()->display_get_brt(DISPLAY_ID(target));
+}
+
+static int scene_write(int target, int value)
+{
+	int ret;
+
+	if(target == DEVICE_DISPLAY_MAX) {
+		ret = BACKEND()->led_set_brt(value);
+	} else {
+		ret = BACKEND()->display_set_brt(DISPLAY_ID(target), value);
+		_device_lease_invalidate(target);
+	}
+	if(ret < 0)
+		return ret;
+
+	_device_state_update(target == DEVICE_DISPLAY_MAX ?
+			DEVICE_PROP_FLASH_BRIGHTNESS : DEVICE_PROP_DISPLAY_BRIGHTNESS(target), value);
+	return 0;
+}
+
+static int _device_scene_apply(const device_scene_s *scene)
+{
+	struct scene_step steps[DEVICE_DISPLAY_MAX + 1];
+	int i, n = 0, max_value, value;
+
+	if(scene == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	/* Validate everything first, against the cached limits */
+	for(i = 0; i < DEVICE_SCENE_DISPLAY_MAX; i++) {
+		value = scene->display_brightness[i];
+		if(value == DEVICE_SCENE_UNCHANGED)
+			continue;
+		if(i >= DEVICE_DISPLAY_MAX || value < 0)
+			RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+		max_value = _device_display_max(i);
+		if(max_value < 0 || value > max_value)
+			RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+		steps[n].target = i;
+		steps[n++].value = value;
+	}
+
+	value = scene->flash_brightness;
+	if(value != DEVICE_SCENE_UNCHANGED) {
+		max_value = _device_flash_max();
+		if(max_value < 0)
+			RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+		if(value < 0 || value > max_value)
+			RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+		steps[n].target = DEVICE_DISPLAY_MAX;
+		steps[n++].value = value;
+	}
+
+	pthread_mutex_lock(&_scene_lock);
+
+	/* The current values, to skip no-op writes and to roll back */
+	for(i = 0; i < n; i++) {
+		steps[i].old = scene_read(steps[i].target);
+		if(steps[i].old < 0) {
+			pthread_mutex_unlock(&_scene_lock);
+			RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+		}
+	}
+
+	for(i = 0; i < n; i++) {
+		if(steps[i].value == steps[i].old)
+			continue;
+		if(scene_write(steps[i].target, steps[i].value) < 0)
+			break;
+	}
+	if(i == n) {
+		pthread_mutex_unlock(&_scene_lock);
+		return DEVICE_ERROR_NONE;
+	}
+
+	LOGE("[%s] fail to apply step %d, rolling back", __FUNCTION__, i);
+	while(--i >= 0) {
+		if(steps[i].value != steps[i].old && scene_write(steps[i].target, steps[i].old) < 0)
+			LOGE("[%s] fail to roll back step %d", __FUNCTION__, i);
+	}
+	pthread_mutex_unlock(&_scene_lock);
+	RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+}
+
+int device_scene_apply(const device_scene_s *scene)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_scene_apply(scene));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+/* devman properties first, then vconf ones, so each backend is visited once */
+static const device_prop_e _query_order[DEVICE_PROP_MAX] = {
+	DEVICE_PROP_DISPLAY_COUNT,
+	DEVICE_PROP_DISPLAY0_BRIGHTNESS,
+	DEVICE_PROP_DISPLAY0_MAX_BRIGHTNESS,
+	DEVICE_PROP_DISPLAY1_BRIGHTNESS,
+	DEVICE_PROP_DISPLAY1_MAX_BRIGHTNESS,
+	DEVICE_PROP_BATTERY_PERCENT,
+	DEVICE_PROP_BATTERY_DETAIL,
+	DEVICE_PROP_BATTERY_FULL,
+	DEVICE_PROP_FLASH_BRIGHTNESS,
+	DEVICE_PROP_FLASH_MAX_BRIGHTNESS,
+	DEVICE_PROP_BATTERY_CHARGING,
+	DEVICE_PROP_BATTERY_WARNING,
+};
+
+static int _query_display(int disp_idx, int disp_count, bool max, int *value)
+{
+	int val;
+
+	if(disp_count < 0)
+		return DEVICE_ERROR_OPERATION_FAILED;
+
+	if(disp_idx >= disp_count)
+		return DEVICE_ERROR_INVALID_PARAMETER;
+
+	if(max)
+		val = BACKEND()->display_get_max_brt(DISPLAY_ID(disp_idx));
+	else
+		val = BACKEND()->display_get_brt(DISPLAY_ID(disp_idx));
+
+	if(val < 0)
+		return DEVICE_ERROR_OPERATION_FAILED;
+
+	*value = val;
+	return DEVICE_ERROR_NONE;
+}
+
+static int _query_prop(device_prop_e prop, int disp_count, int *value)
+{
+	int val;
+	device_battery_warn_e status;
+
+	switch(prop){
+	case DEVICE_PROP_DISPLAY_COUNT:
+		if(disp_count < 0)
+			return DEVICE_ERROR_OPERATION_FAILED;
+		*value = disp_count;
+		return DEVICE_ERROR_NONE;
+	case DEVICE_PROP_DISPLAY0_BRIGHTNESS:
+		return _query_display(0, disp_count, false, value);
+	case DEVICE_PROP_DISPLAY0_MAX_BRIGHTNESS:
+		return _query_display(0, disp_count, true, value);
+	case DEVICE_PROP_DISPLAY1_BRIGHTNESS:
+		return _query_display(1, disp_count, false, value);
+	case DEVICE_PROP_DISPLAY1_MAX_BRIGHTNESS:
+		return _query_display(1, disp_count, true, value);
+	case DEVICE_PROP_BATTERY_PERCENT:
+		val = BACKEND()->battery_get_pct();
+		break;
+	case DEVICE_PROP_BATTERY_DETAIL:
+		val = BACKEND()->battery_get_pct_raw();
+		if(val == -ENODEV)
+			return DEVICE_ERROR_NOT_SUPPORTED;
+		break;
+	case DEVICE_PROP_BATTERY_FULL:
+		val = BACKEND()->battery_is_full();
+		if(val > 0)
+			val = 1;
+		break;
+	case DEVICE_PROP_FLASH_BRIGHTNESS:
+		val = BACKEND()->led_get_brt();
+		break;
+	case DEVICE_PROP_FLASH_MAX_BRIGHTNESS:
+		val = BACKEND()->led_get_max();
+		break;
+	case DEVICE_PROP_BATTERY_CHARGING:
+		if(BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_CHARGE_NOW, &val) < 0 || (val != 0 && val != 1))
+			return DEVICE_ERROR_OPERATION_FAILED;
+		break;
+	case DEVICE_PROP_BATTERY_WARNING:
+		if(BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_STATUS_LOW, &val) < 0 || _device_battery_warn_status(val, &status) < 0)
+			return DEVICE_ERROR_OPERATION_FAILED;
+		val = status;
+		break;
+	default:
+		return DEVICE_ERROR_INVALID_PARAMETER;
+	}
+
+	if(val < 0)
+		return DEVICE_ERROR_OPERATION_FAILED;
+
+	*value = val;
+	return DEVICE_ERROR_NONE;
+}
+
+static int _device_query(const device_prop_e *keys, int count, device_value_s *values)
+{
+	int i, prop, disp_count = -1;
+	bool wanted[DEVICE_PROP_MAX] = { false, };
+	int result[DEVICE_PROP_MAX] = { 0, };
+	int error[DEVICE_PROP_MAX];
+
+	if(keys == NULL || values == NULL || count <= 0)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	for(i = 0; i < count; i++){
+		if(keys[i] < 0 || keys[i] >= DEVICE_PROP_MAX)
+			RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+		wanted[keys[i]] = true;
+	}
+
+	if(wanted[DEVICE_PROP_DISPLAY_COUNT] ||
+			wanted[DEVICE_PROP_DISPLAY0_BRIGHTNESS] || wanted[DEVICE_PROP_DISPLAY0_MAX_BRIGHTNESS] ||
+			wanted[DEVICE_PROP_DISPLAY1_BRIGHTNESS] || wanted[DEVICE_PROP_DISPLAY1_MAX_BRIGHTNESS])
+		disp_count = DISPLAY_COUNT();
+
+	for(i = 0; i < DEVICE_PROP_MAX; i++){
+		prop = _query_order[i];
+		if(wanted[prop])
+			error[prop] = _query_prop(prop, disp_count, &result[prop]);
+	}
+
+	for(i = 0; i < count; i++){
+		values[i].key = keys[i];
+		values[i].error = error[keys[i]];
+		values[i].value = (error[keys[i]] == DEVICE_ERROR_NONE) ? result[keys[i]] : 0;
+	}
+
+	return DEVICE_ERROR_NONE;
+}
+
+int device_query(const device_prop_e *keys, int count, device_value_s *values)
+{
+	int ret;
+
+	FTRACE_BEGIN("count=%d", count);
+	_device_call_begin();
+	ret = _device_call_end(_device_query(keys, count, values));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+#define ASYNC_WORKER_MAX 2
+#define ASYNC_QUEUE_MAX 32
+
+/*
+ * Every request is queued on a lane and a lane is served by at most one
+ * worker at a time, so requests on the same display never overtake each other.
+ */
+enum {
+	ASYNC_LANE_DISPLAY_0,
+	ASYNC_LANE_DISPLAY_1,
+	ASYNC_LANE_BATTERY,
+	ASYNC_LANE_MAX,
+};
+
+typedef enum {
+	ASYNC_OP_GET_BRIGHTNESS,
+	ASYNC_OP_SET_BRIGHTNESS,
+	ASYNC_OP_BATTERY_PERCENT,
+	ASYNC_OP_BATTERY_DETAIL,
+} async_op_e;
+
+struct async_req {
+	int id;
+	async_op_e op;
+	int disp_idx;
+	int value;
+	device_async_cb cb;
+	void *user_data;
+	unsigned long long deadline;	/* 0 for none */
+	struct async_req *next;
+};
+
+struct async_lane {
+	struct async_req *head;
+	struct async_req *tail;
+	int busy;
+};
+
+static struct async_req _reqs[ASYNC_QUEUE_MAX];
+static struct async_req *_free_reqs;
+static struct async_lane _lanes[ASYNC_LANE_MAX];
+static int _last_id;
+
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _cond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+static int _workers;
+
+static void execute(struct async_req *req, int *value, int *error)
+{
+	switch (req->op) {
+	case ASYNC_OP_GET_BRIGHTNESS:
+		*error = device_get_brightness(req->disp_idx, value);
+		break;
+	case ASYNC_OP_SET_BRIGHTNESS:
+		*error = device_set_brightness(req->disp_idx, req->value);
+		*value = req->value;
+		break;
+	case ASYNC_OP_BATTERY_PERCENT:
+		*error = device_battery_get_percent(value);
+		break;
+	case ASYNC_OP_BATTERY_DETAIL:
+		*error = device_battery_get_detail(value);
+		break;
+	default:
+		*error = DEVICE_ERROR_INVALID_PARAMETER;
+		break;
+	}
+}
+
+/* Must be called with _lock held */
+static struct async_req *take_request(int *lane)
+{
+	int i;
+	struct async_req *req;
+
+	for (i = 0; i < ASYNC_LANE_MAX; i++) {
+		if (_lanes[i].busy || _lanes[i].head == NULL)
+			continue;
+
+		req = _lanes[i].head;
+		_lanes[i].head = req->next;
+		if (_lanes[i].head == NULL)
+			_lanes[i].tail = NULL;
+		_lanes[i].busy = 1;
+		*lane = i;
+		return req;
+	}
+	return NULL;
+}
+
+static void *worker_main(void *data)
+{
+	struct async_req *req, local;
+	int lane, value, error;
+
+	pthread_mutex_lock(&_lock);
+	while (1) {
+		req = take_request(&lane);
+		if (req == NULL) {
+			pthread_cond_wait(&_cond, &_lock);
+			continue;
+		}
+
+		local = *req;
+		req->next = _free_reqs;
+		_free_reqs = req;
+		pthread_mutex_unlock(&_lock);
+
+		value = 0;
+		if (local.deadline != 0 && _device_now_us() >= local.deadline) {
+			error = DEVICE_ERROR_TIMED_OUT;
+		} else {
+			/* The backend calls of the request share its deadline */
+			_device_call_begin_at(local.deadline);
+			execute(&local, &value, &error);
+			error = _device_call_end(error);
+		}
+		if (local.cb != NULL)
+			local.cb(local.id, error, value, local.user_data);
+
+		pthread_mutex_lock(&_lock);
+		_lanes[lane].busy = 0;
+		if (_lanes[lane].head != NULL)
+			pthread_cond_signal(&_cond);
+	}
+	pthread_mutex_unlock(&_lock);
+	return NULL;
+}
+
+static void async_init(void)
+{
+	int i;
+	pthread_t th;
+	pthread_attr_t attr;
+
+	for (i = 0; i < ASYNC_QUEUE_MAX; i++) {
+		_reqs[i].next = _free_reqs;
+		_free_reqs = &_reqs[i];
+	}
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	for (i = 0; i < ASYNC_WORKER_MAX; i++) {
+		if (pthread_create(&th, &attr, worker_main, NULL) == 0)
+			_workers++;
+	}
+	pthread_attr_destroy(&attr);
+}
+
+static int submit(int lane, async_op_e op, int disp_idx, int value,
+		device_async_cb cb, void *user_data, int *request_id)
+{
+	unsigned long long deadline = _device_call_deadline();
+	struct async_req *req;
+
+	pthread_once(&_once, async_init);
+	if (_workers == 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	pthread_mutex_lock(&_lock);
+	req = _free_reqs;
+	if (req == NULL) {
+		pthread_mutex_unlock(&_lock);
+		RETURN_ERR(DEVICE_ERROR_RESOURCE_BUSY);
+	}
+	_free_reqs = req->next;
+
+	if (++_last_id <= 0)
+		_last_id = 1;
+	req->id = _last_id;
+	req->op = op;
+	req->disp_idx = disp_idx;
+	req->value = value;
+	req->cb = cb;
+	req->user_data = user_data;
+	req->deadline = deadline;
+	req->next = NULL;
+
+	if (_lanes[lane].tail != NULL)
+		_lanes[lane].tail->next = req;
+	else
+		_lanes[lane].head = req;
+	_lanes[lane].tail = req;
+
+	if (request_id != NULL)
+		*request_id = req->id;
+
+	pthread_cond_signal(&_cond);
+	pthread_mutex_unlock(&_lock);
+
+	return DEVICE_ERROR_NONE;
+}
+
+int device_get_brightness_async(int disp_idx, device_async_cb callback, void *user_data, int *request_id)
+{
+	if (callback == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	if (disp_idx < 0 || disp_idx >= DEVICE_DISPLAY_MAX)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	return submit(ASYNC_LANE_DISPLAY_0 + disp_idx, ASYNC_OP_GET_BRIGHTNESS,
+			disp_idx, 0, callback, user_data, request_id);
+}
+
+int device_set_brightness_async(int disp_idx, int new_value, device_async_cb callback, void *user_data, int *request_id)
+{
+	if (disp_idx < 0 || disp_idx >= DEVICE_DISPLAY_MAX)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	if (new_value < 0)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	return submit(ASYNC_LANE_DISPLAY_0 + disp_idx, ASYNC_OP_SET_BRIGHTNESS,
+			disp_idx, new_value, callback, user_data, request_id);
+}
+
+int device_battery_get_percent_async(device_async_cb callback, void *user_data, int *request_id)
+{
+	if (callback == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	return submit(ASYNC_LANE_BATTERY, ASYNC_OP_BATTERY_PERCENT,
+			0, 0, callback, user_data, request_id);
+}
+
+int device_battery_get_detail_async(device_async_cb callback, void *user_data, int *request_id)
+{
+	if (callback == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	return submit(ASYNC_LANE_BATTERY, ASYNC_OP_BATTERY_DETAIL,
+			0, 0, callback, user_data, request_id);
+}
+
+int device_async_cancel(int request_id)
+{
+	int i;
+	struct async_req *req, *prev;
+
+	if (request_id <= 0)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	pthread_mutex_lock(&_lock);
+	for (i = 0; i < ASYNC_LANE_MAX; i++) {
+		for (prev = NULL, req = _lanes[i].head; req != NULL; prev = req, req = req->next) {
+			if (req->id != request_id)
+				continue;
+
+			if (prev != NULL)
+				prev->next = req->next;
+			else
+				_lanes[i].head = req->next;
+			if (_lanes[i].tail == req)
+				_lanes[i].tail = prev;
+
+			req->next = _free_reqs;
+			_free_reqs = req;
+			pthread_mutex_unlock(&_lock);
+			return DEVICE_ERROR_NONE;
+		}
+	}
+	pthread_mutex_unlock(&_lock);
+
+	RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+}
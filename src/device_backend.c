@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <devman.h>
+#include <device.h>
+#include <dlog.h>
+#include <vconf.h>
+#include <device_private.h>
+
+#ifndef DEVMAN_LIBRARY
+#define DEVMAN_LIBRARY "libdevman.so.0"
+#endif
+
+#ifndef VCONF_LIBRARY
+#define VCONF_LIBRARY "libvconf.so.0"
+#endif
+
+/*
+ * devman and vconf are not linked, each subsystem resolves the symbols it
+ * needs the first time it is used. A process that only reads the battery
+ * never pays for the display or LED symbols, and one that never touches
+ * the library does not load devman or vconf at all.
+ */
+typedef enum {
+	SUBSYS_DISPLAY,
+	SUBSYS_BATTERY,
+	SUBSYS_LED,
+	SUBSYS_VCONF,
+	SUBSYS_MAX,
+} subsys_e;
+
+static const char *_subsys_name[SUBSYS_MAX] = {
+	"display", "battery", "led", "vconf",
+};
+
+static struct {
+	int (*get_display_count)(void);
+	int (*get_display_brt)(display_num_t disp);
+	int (*set_display_brt)(display_num_t disp, int val);
+	int (*get_max_brt)(display_num_t disp);
+	int (*release_brt_ctrl)(display_num_t disp);
+} _display;
+
+static struct {
+	int (*get_battery_pct)(void);
+	int (*get_battery_pct_raw)(void);
+	int (*is_battery_full)(void);
+} _battery;
+
+static struct {
+	int (*get_led_brt)(void);
+	int (*set_led_brt)(int val);
+	int (*get_max_led)(void);
+} _led;
+
+static struct {
+	int (*get_int)(const char *key, int *intval);
+	int (*notify_key_changed)(const char *key, vconf_callback_fn cb, void *data);
+	int (*ignore_key_changed)(const char *key, vconf_callback_fn cb);
+	int (*keynode_get_int)(const keynode_t *keynode);
+} _vconf;
+
+static void *_devman_handle;
+static void *_vconf_handle;
+static pthread_mutex_t _handle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t _once[SUBSYS_MAX] = {
+	PTHREAD_ONCE_INIT, PTHREAD_ONCE_INIT, PTHREAD_ONCE_INIT, PTHREAD_ONCE_INIT,
+};
+
+static void *open_library(void **handle, const char *name)
+{
+	void *h;
+
+	/* the display, battery and LED subsystems share the devman handle */
+	pthread_mutex_lock(&_handle_lock);
+	if (*handle == NULL) {
+		*handle = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+		if (*handle == NULL)
+			LOGE("[%s] fail to load %s : %s", __FUNCTION__, name, dlerror());
+	}
+	h = *handle;
+	pthread_mutex_unlock(&_handle_lock);
+
+	return h;
+}
+
+static void *symbol(void *handle, const char *name)
+{
+	void *sym = (handle != NULL) ? dlsym(handle, name) : NULL;
+
+	if (handle != NULL && sym == NULL)
+		LOGE("[%s] fail to resolve %s", __FUNCTION__, name);
+	return sym;
+}
+
+static void loaded(subsys_e idx, unsigned long long start)
+{
+	LOGD("[%s] %s backend resolved in %lluus", __FUNCTION__, _subsys_name[idx], _device_now_us() - start);
+}
+
+static void load_display(void)
+{
+	unsigned long long start = _device_now_us();
+	void *h = open_library(&_devman_handle, DEVMAN_LIBRARY);
+
+	*(void **)&_display.get_display_count = symbol(h, "device_get_display_count");
+	*(void **)&_display.get_display_brt = symbol(h, "device_get_display_brt");
+	*(void **)&_display.set_display_brt = symbol(h, "device_set_display_brt");
+	*(void **)&_display.get_max_brt = symbol(h, "device_get_max_brt");
+	*(void **)&_display.release_brt_ctrl = symbol(h, "device_release_brt_ctrl");
+	loaded(SUBSYS_DISPLAY, start);
+}
+
+static void load_battery(void)
+{
+	unsigned long long start = _device_now_us();
+	void *h = open_library(&_devman_handle, DEVMAN_LIBRARY);
+
+	*(void **)&_battery.get_battery_pct = symbol(h, "device_get_battery_pct");
+	*(void **)&_battery.get_battery_pct_raw = symbol(h, "device_get_battery_pct_raw");
+	*(void **)&_battery.is_battery_full = symbol(h, "device_is_battery_full");
+	loaded(SUBSYS_BATTERY, start);
+}
+
+static void load_led(void)
+{
+	unsigned long long start = _device_now_us();
+	void *h = open_library(&_devman_handle, DEVMAN_LIBRARY);
+
+	*(void **)&_led.get_led_brt = symbol(h, "device_get_led_brt");
+	*(void **)&_led.set_led_brt = symbol(h, "device_set_led_brt");
+	*(void **)&_led.get_max_led = symbol(h, "device_get_max_led");
+	loaded(SUBSYS_LED, start);
+}
+
+static void load_vconf(void)
+{
+	unsigned long long start = _device_now_us();
+	void *h = open_library(&_vconf_handle, VCONF_LIBRARY);
+
+	*(void **)&_vconf.get_int = symbol(h, "vconf_get_int");
+	*(void **)&_vconf.notify_key_changed = symbol(h, "vconf_notify_key_changed");
+	*(void **)&_vconf.ignore_key_changed = symbol(h, "vconf_ignore_key_changed");
+	*(void **)&_vconf.keynode_get_int = symbol(h, "vconf_keynode_get_int");
+	loaded(SUBSYS_VCONF, start);
+}
+
+static void (*_load[SUBSYS_MAX])(void) = {
+	load_display, load_battery, load_led, load_vconf,
+};
+
+#define RESOLVE(idx, table, func) \
+	(pthread_once(&_once[idx], _load[idx]), (table).func)
+
+static int devman_display_count(void)
+{
+	int (*func)(void) = RESOLVE(SUBSYS_DISPLAY, _display, get_display_count);
+	return func ? func() : -1;
+}
+
+static int devman_display_get_brt(int disp)
+{
+	int (*func)(display_num_t) = RESOLVE(SUBSYS_DISPLAY, _display, get_display_brt);
+	return func ? func(disp) : -1;
+}
+
+static int devman_display_set_brt(int disp, int value)
+{
+	int (*func)(display_num_t, int) = RESOLVE(SUBSYS_DISPLAY, _display, set_display_brt);
+	return func ? func(disp, value) : -1;
+}
+
+static int devman_display_get_max_brt(int disp)
+{
+	int (*func)(display_num_t) = RESOLVE(SUBSYS_DISPLAY, _display, get_max_brt);
+	return func ? func(disp) : -1;
+}
+
+static int devman_display_release_brt(int disp)
+{
+	int (*func)(display_num_t) = RESOLVE(SUBSYS_DISPLAY, _display, release_brt_ctrl);
+	return func ? func(disp) : -1;
+}
+
+static int devman_battery_get_pct(void)
+{
+	int (*func)(void) = RESOLVE(SUBSYS_BATTERY, _battery, get_battery_pct);
+	return func ? func() : -1;
+}
+
+static int devman_battery_get_pct_raw(void)
+{
+	int (*func)(void) = RESOLVE(SUBSYS_BATTERY, _battery, get_battery_pct_raw);
+	return func ? func() : -1;
+}
+
+static int devman_battery_is_full(void)
+{
+	int (*func)(void) = RESOLVE(SUBSYS_BATTERY, _battery, is_battery_full);
+	return func ? func() : -1;
+}
+
+static int devman_led_get_brt(void)
+{
+	int (*func)(void) = RESOLVE(SUBSYS_LED, _led, get_led_brt);
+	return func ? func() : -1;
+}
+
+static int devman_led_set_brt(int value)
+{
+	int (*func)(int) = RESOLVE(SUBSYS_LED, _led, set_led_brt);
+	return func ? func(value) : -1;
+}
+
+static int devman_led_get_max(void)
+{
+	int (*func)(void) = RESOLVE(SUBSYS_LED, _led, get_max_led);
+	return func ? func() : -1;
+}
+
+static int backend_vconf_get_int(const char *key, int *value)
+{
+	int (*func)(const char *, int *) = RESOLVE(SUBSYS_VCONF, _vconf, get_int);
+	return func ? func(key, value) : -1;
+}
+
+static int backend_vconf_notify(const char *key, vconf_callback_fn cb, void *data)
+{
+	int (*func)(const char *, vconf_callback_fn, void *) = RESOLVE(SUBSYS_VCONF, _vconf, notify_key_changed);
+	return func ? func(key, cb, data) : -1;
+}
+
+static int backend_vconf_ignore(const char *key, vconf_callback_fn cb)
+{
+	int (*func)(const char *, vconf_callback_fn) = RESOLVE(SUBSYS_VCONF, _vconf, ignore_key_changed);
+	return func ? func(key, cb) : -1;
+}
+
+static int backend_keynode_get_int(const keynode_t *key)
+{
+	/* only called from a notification, so vconf is already resolved */
+	return _vconf.keynode_get_int ? _vconf.keynode_get_int(key) : -1;
+}
+
+static const struct device_backend _devman_backend = {
+	.name = "devman",
+	.display_count = devman_display_count,
+	.display_get_brt = devman_display_get_brt,
+	.display_set_brt = devman_display_set_brt,
+	.display_get_max_brt = devman_display_get_max_brt,
+	.display_release_brt = devman_display_release_brt,
+	.battery_get_pct = devman_battery_get_pct,
+	.battery_get_pct_raw = devman_battery_get_pct_raw,
+	.battery_is_full = devman_battery_is_full,
+	.led_get_brt = devman_led_get_brt,
+	.led_set_brt = devman_led_set_brt,
+	.led_get_max = devman_led_get_max,
+	.vconf_get_int = backend_vconf_get_int,
+	.vconf_notify = backend_vconf_notify,
+	.vconf_ignore = backend_vconf_ignore,
+	.keynode_get_int = backend_keynode_get_int,
+};
+
+void _device_backend_options(const char *conf, const struct device_backend_option *options, int count)
+{
+	const char *p = conf;
+	size_t len;
+	int i;
+
+	while (p != NULL && *p != '\0') {
+		len = strcspn(p, "=");
+		for (i = 0; i < count; i++) {
+			if (strlen(options[i].name) == len && strncmp(p, options[i].name, len) == 0 && p[len] == '=') {
+				*options[i].value = atoi(p + len + 1);
+				break;
+			}
+		}
+		if (i == count)
+			LOGE("[%s] unknown option %.*s", __FUNCTION__, (int)strcspn(p, "=,"), p);
+
+		p = strchr(p, ',');
+		if (p != NULL)
+			p++;
+	}
+}
+
+static const struct device_backend *_backend = &_devman_backend;
+static pthread_once_t _backend_once = PTHREAD_ONCE_INIT;
+
+static void select_backend(void)
+{
+	const char *name = secure_getenv("CAPI_SYSTEM_DEVICE_BACKEND");
+	const char *path;
+
+	if (name != NULL && strcmp(name, "replay") == 0) {
+		path = secure_getenv("CAPI_SYSTEM_DEVICE_TRACE");
+		_backend = (path != NULL) ? _device_replay_backend(path) : NULL;
+	} else if (name != NULL && strcmp(name, "sim") == 0) {
+		_backend = _device_sim_backend();
+	} else if (name != NULL && strcmp(name, "mock") == 0) {
+		_backend = _device_mock_backend();
+	} else if (name != NULL && strcmp(name, _devman_backend.name) != 0) {
+		LOGE("[%s] unknown backend %s", __FUNCTION__, name);
+	}
+
+	if (_backend == NULL) {
+		LOGE("[%s] fail to set up the %s backend, fall back to devman", __FUNCTION__, name);
+		_backend = &_devman_backend;
+	}
+
+	path = secure_getenv("CAPI_SYSTEM_DEVICE_RECORD");
+	if (path != NULL)
+		_backend = _device_record_backend(_backend, path);
+
+	_backend = _device_timeout_backend(_backend);
+	_backend = _device_retry_backend(_backend);
+
+	LOGI("[%s] %s backend", __FUNCTION__, _backend->name);
+}
+
+const struct device_backend *_device_backend(void)
+{
+	pthread_once(&_backend_once, select_backend);
+	return _backend;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <vconf.h>
+#include <device_private.h>
+
+static struct {
+	device_battery_batch_cb callback;
+	void *user_data;
+	unsigned long long window_us;
+
+	device_battery_state_s state;
+	unsigned int pending;
+	unsigned int events;
+	unsigned long long first;
+} _batch;
+
+static unsigned long long batch_flush(struct device_sched_task *task, unsigned long long now);
+
+static struct device_sched_task _task = {
+	.func = batch_flush,
+};
+
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const device_event_e _events[] = {
+	DEVICE_EVENT_BATTERY_CAPACITY,
+	DEVICE_EVENT_BATTERY_CHARGING,
+	DEVICE_EVENT_BATTERY_WARNING,
+};
+
+static void batch_event_handler(device_event_e event, int value, unsigned long long stamp, void *data)
+{
+	device_battery_warn_e warning;
+	unsigned long long deadline;
+	unsigned int change;
+	int first;
+
+	switch (event) {
+	case DEVICE_EVENT_BATTERY_CAPACITY:
+		change = DEVICE_CHANGE_BATTERY_PERCENT;
+		break;
+	case DEVICE_EVENT_BATTERY_CHARGING:
+		change = DEVICE_CHANGE_BATTERY_CHARGING;
+		break;
+	case DEVICE_EVENT_BATTERY_WARNING:
+		if (_device_battery_warn_status(value, &warning) < 0)
+			return;
+		value = warning;
+		change = DEVICE_CHANGE_BATTERY_WARNING;
+		break;
+	default:
+		return;
+	}
+
+	pthread_mutex_lock(&_lock);
+	if (change == DEVICE_CHANGE_BATTERY_PERCENT)
+		_batch.state.percent = value;
+	else if (change == DEVICE_CHANGE_BATTERY_CHARGING)
+		_batch.state.charging = (value == 1);
+	else
+		_batch.state.warning = value;
+
+	first = (_batch.pending == 0);
+	if (first)
+		_batch.first = stamp;
+	_batch.pending |= change;
+	_batch.events++;
+	/* The end of the window the first pending change happened in */
+	deadline = (_batch.first / _batch.window_us + 1) * _batch.window_us;
+	pthread_mutex_unlock(&_lock);
+
+	if (first && _device_sched_add(&_task, deadline) < 0)
+		LOGE("[%s] fail to schedule the delivery", __FUNCTION__);
+}
+
+static unsigned long long batch_flush(struct device_sched_task *task, unsigned long long now)
+{
+	unsigned long long stamp;
+	unsigned int changes, events;
+
+	pthread_mutex_lock(&_lock);
+	changes = _batch.pending;
+	events = _batch.events;
+	stamp = _batch.first;
+	_batch.pending = 0;
+	_batch.events = 0;
+	pthread_mutex_unlock(&_lock);
+
+	if (changes == 0)
+		return 0;
+	if (events > 1)
+		_device_callback_coalesced(DEVICE_CALLBACK_BATTERY_BATCH, events - 1);
+	_device_executor_submit(DEVICE_CALLBACK_BATTERY_BATCH, changes, stamp);
+
+	return 0;
+}
+
+void _device_batch_invoke(unsigned int changes, unsigned long long stamp)
+{
+	device_battery_batch_cb callback;
+	device_battery_state_s state;
+	void *user_data;
+	unsigned long long entry;
+
+	pthread_mutex_lock(&_lock);
+	callback = _batch.callback;
+	user_data = _batch.user_data;
+	state = _batch.state;
+	pthread_mutex_unlock(&_lock);
+
+	if (callback == NULL) {
+		_device_callback_dropped(DEVICE_CALLBACK_BATTERY_BATCH);
+		return;
+	}
+
+	entry = _device_now_us();
+	callback(changes, &state, user_data);
+	_device_callback_delivered(DEVICE_CALLBACK_BATTERY_BATCH, stamp, entry, _device_now_us());
+}
+
+static void batch_seed(device_battery_state_s *state)
+{
+	device_battery_warn_e warning;
+	int value;
+
+	if (BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_CAPACITY, &value) == 0)
+		state->percent = value;
+	if (BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_CHARGE_NOW, &value) == 0)
+		state->charging = (value == 1);
+	if (BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_STATUS_LOW, &value) == 0 &&
+			_device_battery_warn_status(value, &warning) == 0)
+		state->warning = warning;
+}
+
+static void batch_unsubscribe(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		_device_event_unsubscribe(_events[i], batch_event_handler, NULL);
+}
+
+static int _device_battery_set_batch_cb(int window_ms, device_battery_batch_cb callback, void *user_data)
+{
+	device_battery_state_s state = { .warning = DEVICE_BATTERY_WARN_NORMAL };
+	unsigned int i;
+
+	if (window_ms <= 0 || callback == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	batch_seed(&state);
+
+	pthread_mutex_lock(&_lock);
+	_batch.state = state;
+	_batch.window_us = (unsigned long long)window_ms * 1000;
+	_batch.callback = callback;
+	_batch.user_data = user_data;
+	pthread_mutex_unlock(&_lock);
+
+	for (i = 0; i < sizeof(_events) / sizeof(_events[0]); i++) {
+		if (_device_event_subscribe(_events[i], batch_event_handler, NULL) < 0) {
+			batch_unsubscribe(i);
+			pthread_mutex_lock(&_lock);
+			_batch.callback = NULL;
+			_batch.user_data = NULL;
+			pthread_mutex_unlock(&_lock);
+			RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+		}
+	}
+
+	return DEVICE_ERROR_NONE;
+}
+
+int device_battery_set_batch_cb(int window_ms, device_battery_batch_cb callback, void *user_data)
+{
+	int ret;
+
+	FTRACE_BEGIN("window=%d", window_ms);
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_set_batch_cb(window_ms, callback, user_data));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+int device_battery_unset_batch_cb(void)
+{
+	pthread_mutex_lock(&_lock);
+	if (_batch.callback == NULL) {
+		pthread_mutex_unlock(&_lock);
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	}
+	_batch.callback = NULL;
+	_batch.user_data = NULL;
+	_batch.pending = 0;
+	_batch.events = 0;
+	pthread_mutex_unlock(&_lock);
+
+	batch_unsubscribe(sizeof(_events) / sizeof(_events[0]));
+	_device_sched_cancel(&_task);
+
+	return DEVICE_ERROR_NONE;
+}
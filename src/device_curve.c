@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+/*
+ * Perceptual brightness.
+ *
+ * A percentage maps to a brightness level through a table of 101 levels
+ * per curve, built once per display from its maximum brightness. Floating
+ * point is only used to build the tables; setting is a lookup and getting
+ * is a binary search over the same table, so the two are consistent.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+#define CURVE_STEPS 101
+
+static struct {
+	int built;
+	int curve;
+	int level[DEVICE_BRIGHTNESS_CURVE_MAX][CURVE_STEPS];
+} _curve[DEVICE_DISPLAY_MAX];
+
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Relative luminance of a percentage, 0.0 ~ 1.0 */
+static double curve_luminance(device_brightness_curve_e curve, int percent)
+{
+	double l = percent;
+
+	switch (curve) {
+	case DEVICE_BRIGHTNESS_CURVE_LIGHTNESS:
+		/* Inverse of CIE 1976 L*, with L* = percent */
+		if (l > 8.0)
+			return pow((l + 16.0) / 116.0, 3.0);
+		return l / 903.3;
+	case DEVICE_BRIGHTNESS_CURVE_GAMMA:
+		return pow(l / 100.0, 2.2);
+	default:
+		return l / 100.0;
+	}
+}
+
+static void curve_build(int disp_idx, int max)
+{
+	int *level;
+	int c, p;
+
+	for (c = 0; c < DEVICE_BRIGHTNESS_CURVE_MAX; c++) {
+		level = _curve[disp_idx].level[c];
+		for (p = 0; p < CURVE_STEPS; p++) {
+			level[p] = (int)(curve_luminance(c, p) * max + 0.5);
+			/* A nonzero percentage never turns the display off */
+			if (p > 0 && level[p] < 1)
+				level[p] = 1;
+			if (p > 0 && level[p] < level[p - 1])
+				level[p] = level[p - 1];
+		}
+	}
+}
+
+/* The table of the current curve of a display, built on first use */
+static int curve_table(int disp_idx, const int **table)
+{
+	int max_id, max;
+
+	if (device_get_display_numbers(&max_id) < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	if (disp_idx < 0 || disp_idx >= max_id)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	if (!__atomic_load_n(&_curve[disp_idx].built, __ATOMIC_ACQUIRE)) {
+		max = _device_display_max(disp_idx);
+		if (max <= 0)
+			RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+		pthread_mutex_lock(&_lock);
+		if (!_curve[disp_idx].built) {
+			curve_build(disp_idx, max);
+			__atomic_store_n(&_curve[disp_idx].built, 1, __ATOMIC_RELEASE);
+		}
+		pthread_mutex_unlock(&_lock);
+	}
+
+	*table = _curve[disp_idx].level[__atomic_load_n(&_curve[disp_idx].curve, __ATOMIC_RELAXED)];
+	return DEVICE_ERROR_NONE;
+}
+
+static int _device_set_brightness_curve(int display_index, device_brightness_curve_e curve)
+{
+	int max_id;
+
+	if (curve < 0 || curve >= DEVICE_BRIGHTNESS_CURVE_MAX)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	if (device_get_display_numbers(&max_id) < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	if (display_index < 0 || display_index >= max_id)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	__atomic_store_n(&_curve[display_index].curve, curve, __ATOMIC_RELAXED);
+	return DEVICE_ERROR_NONE;
+}
+
+int device_set_brightness_curve(int display_index, device_brightness_curve_e curve)
+{
+	int ret;
+
+	FTRACE_BEGIN("disp=%d curve=%d", display_index, curve);
+	_device_call_begin();
+	ret = _device_call_end(_device_set_brightness_curve(display_index, curve));
+	FTRACE_END(ret, "disp=%d", display_index);
+
+	return ret;
+}
+
+static int _device_set_brightness_percent(int display_index, int percent)
+{
+	const int *level;
+	int ret;
+
+	if (percent < 0 || percent > 100)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	ret = curve_table(display_index, &level);
+	if (ret < 0)
+		return ret;
+
+	return device_set_brightness(display_index, level[percent]);
+}
+
+int device_set_brightness_percent(int display_index, int percent)
+{
+	int ret;
+
+	FTRACE_BEGIN("disp=%d percent=%d", display_index, percent);
+	_device_call_begin();
+	ret = _device_call_end(_device_set_brightness_percent(display_index, percent));
+	FTRACE_END(ret, "disp=%d", display_index);
+
+	return ret;
+}
+
+static int _device_get_brightness_percent(int display_index, int *percent)
+{
+	const int *level;
+	int value, ret, lo, hi, mid;
+
+	if (percent == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	ret = curve_table(display_index, &level);
+	if (ret < 0)
+		return ret;
+
+	ret = device_get_brightness(display_index, &value);
+	if (ret < 0)
+		return ret;
+
+	/* The first percentage whose level is not below the value */
+	lo = 0;
+	hi = CURVE_STEPS - 1;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (level[mid] < value)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	/* Then the closer of it and the one before, a lit display is never 0 */
+	if (lo > 1 && value - level[lo - 1] < level[lo] - value)
+		lo--;
+	if (value > 0 && lo == 0)
+		lo = 1;
+
+	*percent = lo;
+	return DEVICE_ERROR_NONE;
+}
+
+int device_get_brightness_percent(int display_index, int *percent)
+{
+	int ret;
+
+	FTRACE_BEGIN("disp=%d", display_index);
+	_device_call_begin();
+	ret = _device_call_end(_device_get_brightness_percent(display_index, percent));
+	FTRACE_END(ret, "disp=%d percent=%d", display_index, ret == DEVICE_ERROR_NONE ? *percent : -1);
+
+	return ret;
+}
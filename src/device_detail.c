@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <vconf.h>
+#include <device_private.h>
+
+#define DETAIL_PERIOD_MIN		1000000ULL	/* us */
+#define DETAIL_PERIOD_MAX		300000000ULL
+#define DETAIL_PERIOD_INITIAL	10000000ULL
+#define DETAIL_PERIOD_CHARGING	60000000ULL
+
+/*
+ * The sampler aims at two samples per min_delta of change: the period is
+ * derived from a moving average of the observed rate of change, backs off
+ * through the scheduler while the charge does not move, and is kept long
+ * on a charger.
+ */
+static struct {
+	device_battery_detail_cb callback;
+	void *user_data;
+	int min_delta;
+
+	int delivered;
+	int last;
+	unsigned long long last_time;
+	unsigned long long rate;	/* per ten thousand per hour */
+	unsigned long long period;
+	int charging;
+	int active;
+} _detail;
+
+static unsigned long long detail_sample(struct device_sched_task *task, unsigned long long now);
+
+static struct device_sched_task _task = {
+	.func = detail_sample,
+	.period_min = DETAIL_PERIOD_MIN,
+	.period_max = DETAIL_PERIOD_MAX,
+};
+
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void detail_adapt(int value, unsigned long long now)
+{
+	unsigned long long elapsed = now - _detail.last_time;
+	unsigned long long rate, period;
+
+	if (_detail.last_time != 0 && elapsed > 0) {
+		rate = (unsigned long long)abs(value - _detail.last) * 3600000000ULL / elapsed;
+		_detail.rate = (_detail.rate * 3 + rate) / 4;
+	}
+
+	if (_detail.rate > 0)
+		period = (unsigned long long)_detail.min_delta * 3600000000ULL / _detail.rate / 2;
+	else
+		period = _device_sched_backoff(&_task, 0, now) - now;
+
+	if (_detail.charging && period < DETAIL_PERIOD_CHARGING)
+		period = DETAIL_PERIOD_CHARGING;
+	if (period < DETAIL_PERIOD_MIN)
+		period = DETAIL_PERIOD_MIN;
+	if (period > DETAIL_PERIOD_MAX)
+		period = DETAIL_PERIOD_MAX;
+
+	_detail.period = _task.period = period;
+	_detail.last = value;
+	_detail.last_time = now;
+}
+
+static unsigned long long detail_sample(struct device_sched_task *task, unsigned long long now)
+{
+	unsigned long long next;
+	int value, deliver = 0;
+
+	value = BACKEND()->battery_get_pct_raw();
+
+	pthread_mutex_lock(&_lock);
+	if (!_detail.active) {
+		pthread_mutex_unlock(&_lock);
+		return 0;
+	}
+	if (value < 0) {
+		_detail.period = DETAIL_PERIOD_MAX;
+		_detail.last_time = now;
+	} else {
+		detail_adapt(value, now);
+		if (abs(value - _detail.delivered) >= _detail.min_delta) {
+			_detail.delivered = value;
+			deliver = 1;
+		}
+	}
+	next = _detail.last_time + _detail.period;
+	pthread_mutex_unlock(&_lock);
+
+	if (value < 0)
+		return next;
+
+	if (deliver)
+		_device_executor_submit(DEVICE_CALLBACK_BATTERY_DETAIL, value, now);
+	return next;
+}
+
+/* A percentage or charging change means the detail moved, sample it now */
+static void detail_event_handler(device_event_e event, int value, unsigned long long stamp, void *data)
+{
+	pthread_mutex_lock(&_lock);
+	if (event == DEVICE_EVENT_BATTERY_CHARGING)
+		_detail.charging = (value == 1);
+	pthread_mutex_unlock(&_lock);
+
+	_device_sched_add(&_task, stamp);
+}
+
+void _device_detail_invoke(int detail, unsigned long long stamp)
+{
+	device_battery_detail_cb callback;
+	void *user_data;
+	unsigned long long entry;
+
+	pthread_mutex_lock(&_lock);
+	callback = _detail.callback;
+	user_data = _detail.user_data;
+	pthread_mutex_unlock(&_lock);
+
+	if (callback == NULL) {
+		_device_callback_dropped(DEVICE_CALLBACK_BATTERY_DETAIL);
+		return;
+	}
+
+	entry = _device_now_us();
+	callback(detail, user_data);
+	_device_callback_delivered(DEVICE_CALLBACK_BATTERY_DETAIL, stamp, entry, _device_now_us());
+}
+
+static int _device_battery_set_detail_cb(int min_delta, device_battery_detail_cb callback, void *user_data)
+{
+	int value, charging = 0;
+
+	if (min_delta <= 0 || callback == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	value = BACKEND()->battery_get_pct_raw();
+	if (value == -ENODEV)
+		RETURN_ERR(DEVICE_ERROR_NOT_SUPPORTED);
+	if (value < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	if (BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_CHARGE_NOW, &charging) < 0)
+		charging = 0;
+
+	if (_device_event_subscribe(DEVICE_EVENT_BATTERY_CAPACITY, detail_event_handler, NULL) < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	if (_device_event_subscribe(DEVICE_EVENT_BATTERY_CHARGING, detail_event_handler, NULL) < 0) {
+		_device_event_unsubscribe(DEVICE_EVENT_BATTERY_CAPACITY, detail_event_handler, NULL);
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	}
+
+	pthread_mutex_lock(&_lock);
+	_detail.callback = callback;
+	_detail.user_data = user_data;
+	_detail.min_delta = min_delta;
+	_detail.delivered = value;
+	_detail.last = value;
+	_detail.last_time = _device_now_us();
+	_detail.rate = 0;
+	_detail.period = DETAIL_PERIOD_INITIAL;
+	/* The back off doubles from here, not from whatever the last arming left */
+	_task.period = DETAIL_PERIOD_INITIAL;
+	_detail.charging = (charging == 1);
+	_detail.active = 1;
+	pthread_mutex_unlock(&_lock);
+
+	if (_device_sched_add(&_task, _detail.last_time + DETAIL_PERIOD_INITIAL) < 0) {
+		device_battery_unset_detail_cb();
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	}
+
+	return DEVICE_ERROR_NONE;
+}
+
+int device_battery_set_detail_cb(int min_delta, device_battery_detail_cb callback, void *user_data)
+{
+	int ret;
+
+	FTRACE_BEGIN("min_delta=%d", min_delta);
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_set_detail_cb(min_delta, callback, user_data));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+int device_battery_unset_detail_cb(void)
+{
+	pthread_mutex_lock(&_lock);
+	if (!_detail.active) {
+		pthread_mutex_unlock(&_lock);
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	}
+	_detail.active = 0;
+	_detail.callback = NULL;
+	_detail.user_data = NULL;
+	pthread_mutex_unlock(&_lock);
+
+	_device_event_unsubscribe(DEVICE_EVENT_BATTERY_CAPACITY, detail_event_handler, NULL);
+	_device_event_unsubscribe(DEVICE_EVENT_BATTERY_CHARGING, detail_event_handler, NULL);
+	_device_sched_cancel(&_task);
+
+	return DEVICE_ERROR_NONE;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <vconf.h>
+#include <device_private.h>
+
+#define EVENT_HANDLER_MAX 8
+
+/*
+ * All vconf subscriptions of the library go through this dispatcher.
+ * Each key is registered once with its event id as user data, so the
+ * notification path neither compares key names nor reads the key again.
+ */
+static const char *_event_keys[DEVICE_EVENT_MAX] = {
+	[DEVICE_EVENT_BATTERY_CAPACITY] = VCONFKEY_SYSMAN_BATTERY_CAPACITY,
+	[DEVICE_EVENT_BATTERY_CHARGING] = VCONFKEY_SYSMAN_BATTERY_CHARGE_NOW,
+	[DEVICE_EVENT_BATTERY_WARNING] = VCONFKEY_SYSMAN_BATTERY_STATUS_LOW,
+};
+
+struct event_handler {
+	device_event_handler func;
+	void *data;
+};
+
+struct event_slot {
+	struct event_handler handlers[EVENT_HANDLER_MAX];
+	int count;
+};
+
+static struct event_slot _slots[DEVICE_EVENT_MAX];
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+void _device_event_dispatch(device_event_e event, int value, unsigned long long stamp)
+{
+	struct event_handler handlers[EVENT_HANDLER_MAX];
+	int i, count;
+
+	if (event < 0 || event >= DEVICE_EVENT_MAX)
+		return;
+
+	/* Handlers may (un)subscribe from inside the callback, so work on a copy */
+	pthread_mutex_lock(&_lock);
+	count = _slots[event].count;
+	for (i = 0; i < count; i++)
+		handlers[i] = _slots[event].handlers[i];
+	pthread_mutex_unlock(&_lock);
+
+	/* A retry delay here would hold back every later notification */
+	_device_retry_suspend();
+	for (i = 0; i < count; i++)
+		handlers[i].func(event, value, stamp, handlers[i].data);
+	_device_retry_resume();
+}
+
+static void event_changed_inside_cb(keynode_t* key, void* user_data)
+{
+	unsigned long long stamp = _device_now_us();
+	device_event_e event = (device_event_e)(long)user_data;
+	int value = BACKEND()->keynode_get_int(key);
+
+	_device_record_event(event, value);
+	_device_event_dispatch(event, value, stamp);
+}
+
+int _device_event_from_key(const char *key)
+{
+	int i;
+
+	for (i = 0; i < DEVICE_EVENT_MAX; i++) {
+		if (strcmp(key, _event_keys[i]) == 0)
+			return i;
+	}
+	return -1;
+}
+
+int _device_event_subscribe(device_event_e event, device_event_handler handler, void *data)
+{
+	struct event_slot *slot;
+	int i;
+
+	if (event < 0 || event >= DEVICE_EVENT_MAX || handler == NULL)
+		return -1;
+
+	pthread_mutex_lock(&_lock);
+	slot = &_slots[event];
+	for (i = 0; i < slot->count; i++) {
+		if (slot->handlers[i].func == handler && slot->handlers[i].data == data) {
+			pthread_mutex_unlock(&_lock);
+			return 0;
+		}
+	}
+
+	if (slot->count == EVENT_HANDLER_MAX) {
+		pthread_mutex_unlock(&_lock);
+		LOGE("[%s] too many handlers for %s", __FUNCTION__, _event_keys[event]);
+		return -1;
+	}
+
+	if (slot->count == 0 &&
+			BACKEND()->vconf_notify(_event_keys[event], event_changed_inside_cb, (void*)(long)event) < 0) {
+		pthread_mutex_unlock(&_lock);
+		LOGE("[%s] fail to watch %s", __FUNCTION__, _event_keys[event]);
+		return -1;
+	}
+
+	slot->handlers[slot->count].func = handler;
+	slot->handlers[slot->count].data = data;
+	slot->count++;
+	pthread_mutex_unlock(&_lock);
+
+	return 0;
+}
+
+int _device_event_unsubscribe(device_event_e event, device_event_handler handler, void *data)
+{
+	struct event_slot *slot;
+	int i, ret = -1;
+
+	if (event < 0 || event >= DEVICE_EVENT_MAX)
+		return -1;
+
+	pthread_mutex_lock(&_lock);
+	slot = &_slots[event];
+	for (i = 0; i < slot->count; i++) {
+		if (slot->handlers[i].func != handler || slot->handlers[i].data != data)
+			continue;
+
+		slot->handlers[i] = slot->handlers[--slot->count];
+		ret = 0;
+		break;
+	}
+
+	if (ret == 0 && slot->count == 0 &&
+			BACKEND()->vconf_ignore(_event_keys[event], event_changed_inside_cb) < 0)
+		ret = -1;
+	pthread_mutex_unlock(&_lock);
+
+	return ret;
+}
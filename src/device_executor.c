@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+#define EXECUTOR_QUEUE_MAX 64	/* power of two */
+
+/*
+ * Bounded multi-producer single-consumer ring. Producers are the threads
+ * notifications arrive on, they claim a cell with one CAS on the tail and
+ * publish it through its sequence number, so the notification path never
+ * blocks on the consumer. The consumer is the executor thread of the
+ * callback, woken once per published cell.
+ */
+struct executor_cell {
+	unsigned int seq;
+	int value;
+	unsigned long long stamp;
+};
+
+/*
+ * What runs a callback. Configs are immutable once published and never
+ * freed, so the notification path reads them with one atomic load and no
+ * lock. Inline and thread are shared constants, dispatch configs are
+ * allocated and kept for reuse when the same function and data come back.
+ */
+struct executor_config {
+	device_executor_e type;
+	device_dispatch_cb dispatch;
+	void *data;
+	struct executor_config *next;
+};
+
+struct executor {
+	const struct executor_config *config;
+
+	struct executor_cell cells[EXECUTOR_QUEUE_MAX];
+	unsigned int head;
+	unsigned int tail;
+	sem_t ready;
+	int running;
+};
+
+static const struct executor_config _inline_config = { .type = DEVICE_EXECUTOR_INLINE };
+static const struct executor_config _thread_config = { .type = DEVICE_EXECUTOR_THREAD };
+static struct executor_config *_dispatch_configs;
+
+static struct executor _executors[DEVICE_CALLBACK_MAX];
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Called with _lock held */
+static const struct executor_config *dispatch_config(device_dispatch_cb dispatch, void *data)
+{
+	struct executor_config *config;
+
+	for (config = _dispatch_configs; config != NULL; config = config->next) {
+		if (config->dispatch == dispatch && config->data == data)
+			return config;
+	}
+
+	config = malloc(sizeof(*config));
+	if (config == NULL)
+		return NULL;
+
+	config->type = DEVICE_EXECUTOR_DISPATCH;
+	config->dispatch = dispatch;
+	config->data = data;
+	config->next = _dispatch_configs;
+	_dispatch_configs = config;
+	return config;
+}
+
+static int enqueue(struct executor *ex, int value, unsigned long long stamp)
+{
+	struct executor_cell *cell;
+	unsigned int pos, seq;
+
+	pos = __atomic_load_n(&ex->tail, __ATOMIC_RELAXED);
+	for (;;) {
+		cell = &ex->cells[pos & (EXECUTOR_QUEUE_MAX - 1)];
+		seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+		if ((int)(seq - pos) == 0) {
+			if (__atomic_compare_exchange_n(&ex->tail, &pos, pos + 1, 1,
+						__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		} else if ((int)(seq - pos) < 0) {
+			return -1;
+		} else {
+			pos = __atomic_load_n(&ex->tail, __ATOMIC_RELAXED);
+		}
+	}
+
+	cell->value = value;
+	cell->stamp = stamp;
+	__atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+	return pos + 1 - __atomic_load_n(&ex->head, __ATOMIC_RELAXED);
+}
+
+static void dequeue(struct executor *ex, int *value, unsigned long long *stamp)
+{
+	struct executor_cell *cell = &ex->cells[ex->head & (EXECUTOR_QUEUE_MAX - 1)];
+
+	/* The semaphore counts published cells, but the head one may still be in flight */
+	while (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != ex->head + 1)
+		sched_yield();
+
+	*value = cell->value;
+	*stamp = cell->stamp;
+	__atomic_store_n(&cell->seq, ex->head + EXECUTOR_QUEUE_MAX, __ATOMIC_RELEASE);
+	__atomic_store_n(&ex->head, ex->head + 1, __ATOMIC_RELAXED);
+}
+
+static void *executor_main(void *data)
+{
+	device_callback_e callback = (device_callback_e)(long)data;
+	struct executor *ex = &_executors[callback];
+	unsigned long long stamp;
+	int value;
+
+	for (;;) {
+		while (sem_wait(&ex->ready) < 0 && errno == EINTR)
+			;
+		dequeue(ex, &value, &stamp);
+		_device_callback_invoke(callback, value, stamp);
+	}
+	return NULL;
+}
+
+static int executor_start(device_callback_e callback)
+{
+	struct executor *ex = &_executors[callback];
+	pthread_t th;
+	unsigned int i;
+
+	if (ex->running)
+		return 0;
+
+	for (i = 0; i < EXECUTOR_QUEUE_MAX; i++)
+		ex->cells[i].seq = i;
+	ex->head = ex->tail = 0;
+
+	if (sem_init(&ex->ready, 0, 0) < 0)
+		return -1;
+
+	if (pthread_create(&th, NULL, executor_main, (void*)(long)callback) != 0) {
+		sem_destroy(&ex->ready);
+		return -1;
+	}
+	pthread_detach(th);
+
+	/* The thread is kept once started, switching back and forth does not respawn it */
+	ex->running = 1;
+	return 0;
+}
+
+void _device_executor_submit(device_callback_e callback, int value, unsigned long long stamp)
+{
+	struct executor *ex = &_executors[callback];
+	const struct executor_config *config;
+	int depth;
+
+	config = __atomic_load_n(&ex->config, __ATOMIC_ACQUIRE);
+	if (config == NULL)
+		config = &_inline_config;
+
+	switch (config->type) {
+	case DEVICE_EXECUTOR_THREAD:
+		depth = enqueue(ex, value, stamp);
+		if (depth < 0) {
+			_device_callback_overflow(callback);
+			break;
+		}
+		_device_callback_queued(callback, depth);
+		sem_post(&ex->ready);
+		break;
+	case DEVICE_EXECUTOR_DISPATCH:
+		config->dispatch(callback, value, stamp, config->data);
+		break;
+	default:
+		_device_callback_invoke(callback, value, stamp);
+		break;
+	}
+}
+
+int device_callback_set_executor(device_callback_e callback, device_executor_e executor,
+		device_dispatch_cb dispatch, void *user_data)
+{
+	const struct executor_config *config;
+
+	if (callback < 0 || callback >= DEVICE_CALLBACK_MAX)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+	if (executor < DEVICE_EXECUTOR_INLINE || executor > DEVICE_EXECUTOR_DISPATCH)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+	if (executor == DEVICE_EXECUTOR_DISPATCH && dispatch == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	pthread_mutex_lock(&_lock);
+	if (executor == DEVICE_EXECUTOR_THREAD && executor_start(callback) < 0) {
+		pthread_mutex_unlock(&_lock);
+		LOGE("[%s] fail to start the executor thread", __FUNCTION__);
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	}
+
+	if (executor == DEVICE_EXECUTOR_DISPATCH)
+		config = dispatch_config(dispatch, user_data);
+	else if (executor == DEVICE_EXECUTOR_THREAD)
+		config = &_thread_config;
+	else
+		config = &_inline_config;
+
+	if (config == NULL) {
+		pthread_mutex_unlock(&_lock);
+		LOGE("[%s] fail to allocate the dispatch config", __FUNCTION__);
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	}
+
+	/* The thread is started above, before a submit can see the config that queues to it */
+	__atomic_store_n(&_executors[callback].config, config, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&_lock);
+
+	return DEVICE_ERROR_NONE;
+}
+
+int device_callback_deliver(device_callback_e callback, int value, unsigned long long stamp)
+{
+	if (callback < 0 || callback >= DEVICE_CALLBACK_MAX)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	_device_callback_invoke(callback, value, stamp);
+	return DEVICE_ERROR_NONE;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+#define FTRACE_BUF_MAX 256
+
+static const char *_markers[] = {
+	"/sys/kernel/tracing/trace_marker",
+	"/sys/kernel/debug/tracing/trace_marker",
+};
+
+int _device_ftrace_fd = -1;
+static int _pid;
+
+/*
+ * Markers use the "B|pid|name args" / "E|pid|name args" convention of
+ * systrace, so the public calls show up as slices next to the scheduler
+ * and block I/O events of the same trace.
+ */
+void _device_ftrace(char type, const char *fmt, ...)
+{
+	static __thread char buf[FTRACE_BUF_MAX];
+	va_list ap;
+	int fd, len, ret;
+
+	fd = __atomic_load_n(&_device_ftrace_fd, __ATOMIC_RELAXED);
+	if (fd < 0)
+		return;
+
+	len = snprintf(buf, sizeof(buf), "%c|%d|", type, _pid);
+	if (len < 0 || len >= (int)sizeof(buf))
+		return;
+
+	va_start(ap, fmt);
+	ret = vsnprintf(buf + len, sizeof(buf) - len, fmt, ap);
+	va_end(ap);
+	if (ret < 0)
+		return;
+
+	len += ret;
+	if (len >= (int)sizeof(buf))
+		len = sizeof(buf) - 1;
+
+	/*
+	 * Tracing was turned off underneath us, stop trying. The descriptor is
+	 * left open: other threads may still be writing to it, and closing it
+	 * would let them write to whatever file reuses the number.
+	 */
+	if (write(fd, buf, len) < 0)
+		__atomic_store_n(&_device_ftrace_fd, -1, __ATOMIC_RELAXED);
+}
+
+static void __attribute__((constructor)) ftrace_init(void)
+{
+	const char *env = secure_getenv("CAPI_SYSTEM_DEVICE_FTRACE");
+	unsigned int i;
+	int fd = -1;
+
+	if (env == NULL || strcmp(env, "1") != 0)
+		return;
+
+	for (i = 0; i < sizeof(_markers) / sizeof(_markers[0]) && fd < 0; i++)
+		fd = open(_markers[i], O_WRONLY | O_CLOEXEC);
+
+	if (fd < 0) {
+		LOGE("[%s] fail to open trace_marker", __FUNCTION__);
+		return;
+	}
+
+	_pid = getpid();
+	__atomic_store_n(&_device_ftrace_fd, fd, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+/*
+ * Append-only battery history.
+ *
+ * After a 16 byte header the file is a sequence of variable length
+ * records. The first byte of a record is a tag, followed by three
+ * LEB128 varints:
+ *
+ *   keyframe  time, zigzag(percent), zigzag(detail)
+ *   delta     time - previous time, zigzag(percent - previous),
+ *             zigzag(detail - previous)
+ *
+ * The charging state is a bit of the tag. Every recording session starts
+ * with a keyframe, so appending never needs to decode the existing file,
+ * and a keyframe is also written when the wall clock goes backwards and
+ * every HISTORY_KEYFRAME_INTERVAL records. A typical delta record is
+ * 4 to 6 bytes. A record torn by a crash ends the decoding, and is cut
+ * off when the next session starts so that its records stay readable.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <device.h>
+#include <dlog.h>
+#include <vconf.h>
+#include <device_private.h>
+
+#define HISTORY_MAGIC "DEVHIST"
+#define HISTORY_VERSION 1
+#define HISTORY_KEYFRAME_INTERVAL 256
+#define HISTORY_RECORD_MAX (1 + 3 * 10)
+#define HISTORY_DETAIL_DELTA 10				/* per ten thousand */
+#define HISTORY_PERIOD_MIN 60000000ULL		/* us */
+#define HISTORY_PERIOD_MAX 900000000ULL
+
+#define HISTORY_TAG_KEYFRAME	0x01
+#define HISTORY_TAG_CHARGING	0x02
+
+struct history_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+};
+
+static struct {
+	int fd;
+	int records;
+	device_battery_sample_s last;	/* last written */
+	device_battery_sample_s now;	/* latest observed */
+} _hist = { .fd = -1 };
+
+static unsigned long long history_poll(struct device_sched_task *task, unsigned long long now);
+
+static struct device_sched_task _task = {
+	.func = history_poll,
+	.period_min = HISTORY_PERIOD_MIN,
+	.period_max = HISTORY_PERIOD_MAX,
+};
+
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long long wall_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (unsigned long long)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+static uint64_t zigzag(int64_t v)
+{
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v)
+{
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static int put_varint(uint8_t *p, uint64_t v)
+{
+	int n = 0;
+
+	while (v >= 0x80) {
+		p[n++] = (uint8_t)v | 0x80;
+		v >>= 7;
+	}
+	p[n++] = (uint8_t)v;
+	return n;
+}
+
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint64_t *v)
+{
+	int shift = 0;
+
+	*v = 0;
+	while (p < end && shift < 64) {
+		*v |= (uint64_t)(*p & 0x7f) << shift;
+		if (!(*p++ & 0x80))
+			return p;
+		shift += 7;
+	}
+	return NULL;
+}
+
+/* Decodes the record at p, NULL when it is torn or not a record */
+static const uint8_t *history_record(const uint8_t *p, const uint8_t *end, uint8_t *tag,
+		uint64_t *t, uint64_t *pct, uint64_t *detail)
+{
+	if (p >= end || (*p & ~(HISTORY_TAG_KEYFRAME | HISTORY_TAG_CHARGING)) != 0)
+		return NULL;
+
+	*tag = *p++;
+	if ((p = get_varint(p, end, t)) == NULL ||
+			(p = get_varint(p, end, pct)) == NULL ||
+			(p = get_varint(p, end, detail)) == NULL)
+		return NULL;
+	return p;
+}
+
+/* Cuts a torn record left by a crash off the end of the file */
+static int history_recover(int fd, off_t size)
+{
+	const uint8_t *base, *p, *next, *end;
+	uint64_t t, pct, detail;
+	uint8_t tag;
+	off_t valid;
+
+	if (size <= (off_t)sizeof(struct history_header))
+		return 0;
+
+	base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (base == MAP_FAILED)
+		return -1;
+
+	p = base + sizeof(struct history_header);
+	end = base + size;
+	while ((next = history_record(p, end, &tag, &t, &pct, &detail)) != NULL)
+		p = next;
+	valid = p - base;
+	munmap((void*)base, size);
+
+	if (valid == size)
+		return 0;
+
+	LOGI("[%s] drop %lld torn bytes of the history", __FUNCTION__, (long long)(size - valid));
+	return ftruncate(fd, valid);
+}
+
+/* Called with _lock held */
+static void history_append(void)
+{
+	device_battery_sample_s *s = &_hist.now, *l = &_hist.last;
+	uint8_t rec[HISTORY_RECORD_MAX];
+	int keyframe, ret, len = 1;
+	off_t size;
+
+	if (_hist.fd < 0)
+		return;
+	if (s->percent == l->percent && s->charging == l->charging &&
+			abs(s->detail - l->detail) < HISTORY_DETAIL_DELTA)
+		return;
+
+	s->time = wall_ms();
+	keyframe = (_hist.records % HISTORY_KEYFRAME_INTERVAL) == 0 || s->time < l->time;
+
+	rec[0] = (keyframe ? HISTORY_TAG_KEYFRAME : 0) | (s->charging ? HISTORY_TAG_CHARGING : 0);
+	if (keyframe) {
+		len += put_varint(rec + len, s->time);
+		len += put_varint(rec + len, zigzag(s->percent));
+		len += put_varint(rec + len, zigzag(s->detail));
+	} else {
+		len += put_varint(rec + len, s->time - l->time);
+		len += put_varint(rec + len, zigzag((int64_t)s->percent - l->percent));
+		len += put_varint(rec + len, zigzag((int64_t)s->detail - l->detail));
+	}
+
+	/*
+	 * O_APPEND, a record is never interleaved with another writer. A short
+	 * write would glue the next record onto a torn one, so the file is cut
+	 * back to its previous end, and recording stops if even that fails.
+	 */
+	size = lseek(_hist.fd, 0, SEEK_END);
+	ret = write(_hist.fd, rec, len);
+	if (ret != len) {
+		LOGE("[%s] fail to append to the history (%d)", __FUNCTION__, ret < 0 ? errno : 0);
+		if (ret > 0 && (size < 0 || ftruncate(_hist.fd, size) < 0)) {
+			LOGE("[%s] fail to cut the torn record, stop recording", __FUNCTION__);
+			close(_hist.fd);
+			_hist.fd = -1;
+		}
+		return;
+	}
+
+	*l = *s;
+	_hist.records++;
+}
+
+static void history_event_handler(device_event_e event, int value, unsigned long long stamp, void *data)
+{
+	int detail = BACKEND()->battery_get_pct_raw();
+
+	pthread_mutex_lock(&_lock);
+	if (event == DEVICE_EVENT_BATTERY_CAPACITY)
+		_hist.now.percent = value;
+	else
+		_hist.now.charging = (value == 1);
+	_hist.now.detail = detail < 0 ? -1 : detail;
+	history_append();
+	pthread_mutex_unlock(&_lock);
+}
+
+static unsigned long long history_poll(struct device_sched_task *task, unsigned long long now)
+{
+	int detail = BACKEND()->battery_get_pct_raw();
+	int changed;
+
+	pthread_mutex_lock(&_lock);
+	if (_hist.fd < 0) {
+		pthread_mutex_unlock(&_lock);
+		return 0;
+	}
+	changed = detail >= 0 && abs(detail - _hist.last.detail) >= HISTORY_DETAIL_DELTA;
+	if (changed) {
+		_hist.now.detail = detail;
+		history_append();
+	}
+	pthread_mutex_unlock(&_lock);
+
+	return _device_sched_backoff(task, changed, now);
+}
+
+static int history_write_header(int fd)
+{
+	struct history_header header;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+	header.version = HISTORY_VERSION;
+	return write(fd, &header, sizeof(header)) == sizeof(header) ? 0 : -1;
+}
+
+static int history_check_header(int fd)
+{
+	struct history_header header;
+
+	if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+			memcmp(header.magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC)) != 0 ||
+			header.version != HISTORY_VERSION)
+		return -1;
+	return 0;
+}
+
+static int _device_battery_history_start(const char *path)
+{
+	struct stat st;
+	int fd, value, detail;
+
+	if (path == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	pthread_mutex_lock(&_lock);
+	if (_hist.fd >= 0) {
+		pthread_mutex_unlock(&_lock);
+		RETURN_ERR(DEVICE_ERROR_RESOURCE_BUSY);
+	}
+
+	fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		pthread_mutex_unlock(&_lock);
+		if (fd >= 0)
+			close(fd);
+		LOGE("[%s] fail to open %s (%d)", __FUNCTION__, path, errno);
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	}
+
+	if ((st.st_size == 0 ? history_write_header(fd) : history_check_header(fd)) < 0) {
+		pthread_mutex_unlock(&_lock);
+		close(fd);
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+	}
+
+	if (history_recover(fd, st.st_size) < 0) {
+		pthread_mutex_unlock(&_lock);
+		close(fd);
+		LOGE("[%s] fail to recover %s (%d)", __FUNCTION__, path, errno);
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	}
+
+	memset(&_hist.now, 0, sizeof(_hist.now));
+	if (BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_CAPACITY, &value) == 0)
+		_hist.now.percent = value;
+	if (BACKEND()->vconf_get_int(VCONFKEY_SYSMAN_BATTERY_CHARGE_NOW, &value) == 0)
+		_hist.now.charging = (value == 1);
+	detail = BACKEND()->battery_get_pct_raw();
+	_hist.now.detail = detail < 0 ? -1 : detail;
+
+	/* Force the opening keyframe of the session */
+	_hist.fd = fd;
+	_hist.records = 0;
+	_hist.last.percent = -1;
+	history_append();
+	pthread_mutex_unlock(&_lock);
+
+	if (_device_event_subscribe(DEVICE_EVENT_BATTERY_CAPACITY, history_event_handler, NULL) < 0 ||
+			_device_event_subscribe(DEVICE_EVENT_BATTERY_CHARGING, history_event_handler, NULL) < 0 ||
+			_device_sched_add(&_task, _device_now_us() + HISTORY_PERIOD_MIN) < 0) {
+		device_battery_history_stop();
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	}
+
+	return DEVICE_ERROR_NONE;
+}
+
+int device_battery_history_start(const char *path)
+{
+	int ret;
+
+	FTRACE_BEGIN("path=%s", path ? path : "(null)");
+	_device_call_begin();
+	ret = _device_call_end(_device_battery_history_start(path));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+int device_battery_history_stop(void)
+{
+	int fd;
+
+	_device_event_unsubscribe(DEVICE_EVENT_BATTERY_CAPACITY, history_event_handler, NULL);
+	_device_event_unsubscribe(DEVICE_EVENT_BATTERY_CHARGING, history_event_handler, NULL);
+	_device_sched_cancel(&_task);
+
+	pthread_mutex_lock(&_lock);
+	fd = _hist.fd;
+	_hist.fd = -1;
+	pthread_mutex_unlock(&_lock);
+
+	if (fd < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	close(fd);
+	return DEVICE_ERROR_NONE;
+}
+
+int device_battery_history_foreach(const char *path, unsigned long long from, unsigned long long to,
+		device_battery_history_cb callback, void *user_data)
+{
+	device_battery_sample_s sample = { 0, };
+	const uint8_t *base, *p, *end;
+	uint64_t t, pct, detail;
+	struct stat st;
+	uint8_t tag;
+	int fd;
+
+	if (path == NULL || callback == NULL || from > to)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	if (fstat(fd, &st) < 0 || history_check_header(fd) < 0) {
+		close(fd);
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+	}
+
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+	madvise((void*)base, st.st_size, MADV_SEQUENTIAL);
+
+	p = base + sizeof(struct history_header);
+	end = base + st.st_size;
+	while ((p = history_record(p, end, &tag, &t, &pct, &detail)) != NULL) {
+		if (tag & HISTORY_TAG_KEYFRAME) {
+			sample.time = t;
+			sample.percent = unzigzag(pct);
+			sample.detail = unzigzag(detail);
+		} else {
+			sample.time += t;
+			sample.percent += unzigzag(pct);
+			sample.detail += unzigzag(detail);
+		}
+		sample.charging = (tag & HISTORY_TAG_CHARGING) != 0;
+
+		if (sample.time >= from && sample.time <= to && !callback(&sample, user_data))
+			break;
+	}
+
+	munmap((void*)base, st.st_size);
+	return DEVICE_ERROR_NONE;
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+/*
+ * Brightness leases.
+ *
+ * The leases of a display are kept in a list sorted by priority, a new
+ * lease going in front of the ones of equal priority, so the head is the
+ * winner. Every change recomputes the winner and writes the backend only
+ * if the winning value differs from the last one written. Any other write
+ * of the brightness (device_set_brightness(), a scene, the settings) bumps
+ * the write count of the display, and a value is only trusted to still be
+ * on the panel while that count is the one its own write left.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+struct _device_brightness_lease_s {
+	int disp_idx;
+	int priority;
+	int value;
+	struct _device_brightness_lease_s *next;
+};
+
+static struct {
+	struct _device_brightness_lease_s *head;
+	int written;			/* last value written for the leases, -1 if none */
+	unsigned int writes;	/* the write count right after it was written */
+} _lease[DEVICE_DISPLAY_MAX] = {
+	[0 ... DEVICE_DISPLAY_MAX - 1] = { .written = -1 },
+};
+
+/* Every brightness write of a display, bumped without _lock from any path */
+static unsigned int _writes[DEVICE_DISPLAY_MAX];
+
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+void _device_lease_invalidate(int disp_idx)
+{
+	if (disp_idx >= 0 && disp_idx < DEVICE_DISPLAY_MAX)
+		__atomic_add_fetch(&_writes[disp_idx], 1, __ATOMIC_ACQ_REL);
+}
+
+/* Called with _lock held, writes the value of the winner unless it is known to be on the panel */
+static int lease_apply(int disp_idx)
+{
+	struct _device_brightness_lease_s *winner = _lease[disp_idx].head;
+	unsigned int writes = __atomic_load_n(&_writes[disp_idx], __ATOMIC_ACQUIRE);
+	int ret;
+
+	if (winner == NULL) {
+		_lease[disp_idx].written = -1;
+		_device_retry_suspend();
+		ret = device_set_brightness_from_settings(disp_idx);
+		_device_retry_resume();
+		return ret;
+	}
+
+	if (winner->value == _lease[disp_idx].written && writes == _lease[disp_idx].writes)
+		return DEVICE_ERROR_NONE;
+
+	/*
+	 * The write below bumps the count once. Any other write counted
+	 * meanwhile may have landed after it, so the value is not cached.
+	 * It is not retried, a retry delay would stall every lease call.
+	 */
+	_device_retry_suspend();
+	ret = device_set_brightness(disp_idx, winner->value);
+	_device_retry_resume();
+	if (ret == DEVICE_ERROR_NONE && __atomic_load_n(&_writes[disp_idx], __ATOMIC_ACQUIRE) == writes + 1) {
+		_lease[disp_idx].written = winner->value;
+		_lease[disp_idx].writes = writes + 1;
+	} else {
+		_lease[disp_idx].written = -1;
+	}
+	return ret;
+}
+
+/* Called with _lock held */
+static int lease_unlink(struct _device_brightness_lease_s *lease)
+{
+	struct _device_brightness_lease_s **p;
+
+	if (lease->disp_idx < 0 || lease->disp_idx >= DEVICE_DISPLAY_MAX)
+		return -1;
+
+	for (p = &_lease[lease->disp_idx].head; *p != NULL; p = &(*p)->next) {
+		if (*p == lease) {
+			*p = lease->next;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/* Called with _lock held */
+static void lease_link(struct _device_brightness_lease_s *lease)
+{
+	struct _device_brightness_lease_s **p = &_lease[lease->disp_idx].head;
+
+	while (*p != NULL && (*p)->priority > lease->priority)
+		p = &(*p)->next;
+	lease->next = *p;
+	*p = lease;
+}
+
+static int lease_check_value(int disp_idx, int value)
+{
+	int max_value = _device_display_max(disp_idx);
+
+	if (max_value < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	if (value < 0 || value > max_value)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	return DEVICE_ERROR_NONE;
+}
+
+static int _device_brightness_lease_acquire(int display_index, int priority, int value, device_brightness_lease_h *lease)
+{
+	struct _device_brightness_lease_s *l;
+	int max_id, ret;
+
+	if (lease == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	if (device_get_display_numbers(&max_id) < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	if (display_index < 0 || display_index >= max_id)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	ret = lease_check_value(display_index, value);
+	if (ret < 0)
+		return ret;
+
+	l = calloc(1, sizeof(*l));
+	if (l == NULL)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	l->disp_idx = display_index;
+	l->priority = priority;
+	l->value = value;
+
+	pthread_mutex_lock(&_lock);
+	lease_link(l);
+	ret = lease_apply(display_index);
+	if (ret < 0)
+		lease_unlink(l);
+	pthread_mutex_unlock(&_lock);
+
+	if (ret < 0) {
+		free(l);
+		return ret;
+	}
+
+	*lease = l;
+	return DEVICE_ERROR_NONE;
+}
+
+int device_brightness_lease_acquire(int display_index, int priority, int value, device_brightness_lease_h *lease)
+{
+	int ret;
+
+	FTRACE_BEGIN("disp=%d priority=%d value=%d", display_index, priority, value);
+	_device_call_begin();
+	ret = _device_call_end(_device_brightness_lease_acquire(display_index, priority, value, lease));
+	FTRACE_END(ret, "disp=%d", display_index);
+
+	return ret;
+}
+
+static int _device_brightness_lease_update(device_brightness_lease_h lease, int value)
+{
+	int ret, old;
+
+	if (lease == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	ret = lease_check_value(lease->disp_idx, value);
+	if (ret < 0)
+		return ret;
+
+	pthread_mutex_lock(&_lock);
+	old = lease->value;
+	lease->value = value;
+	ret = lease_apply(lease->disp_idx);
+	if (ret < 0)
+		lease->value = old;
+	pthread_mutex_unlock(&_lock);
+
+	return ret;
+}
+
+int device_brightness_lease_update(device_brightness_lease_h lease, int value)
+{
+	int ret;
+
+	FTRACE_BEGIN("value=%d", value);
+	_device_call_begin();
+	ret = _device_call_end(_device_brightness_lease_update(lease, value));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
+
+static int _device_brightness_lease_release(device_brightness_lease_h lease)
+{
+	int ret;
+
+	if (lease == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	pthread_mutex_lock(&_lock);
+	if (lease_unlink(lease) < 0) {
+		pthread_mutex_unlock(&_lock);
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+	}
+	ret = lease_apply(lease->disp_idx);
+	pthread_mutex_unlock(&_lock);
+
+	free(lease);
+	return ret;
+}
+
+int device_brightness_lease_release(device_brightness_lease_h lease)
+{
+	int ret;
+
+	FTRACE_BEGIN("");
+	_device_call_begin();
+	ret = _device_call_end(_device_brightness_lease_release(lease));
+	FTRACE_END(ret, "");
+
+	return ret;
+}
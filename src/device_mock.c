@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+/*
+ * Mock device, selected with CAPI_SYSTEM_DEVICE_BACKEND=mock.
+ *
+ * A device with fixed battery readings and settable brightness that
+ * never notifies, for tests and benchmarks that must not depend on the
+ * hardware. Faults are injected with CAPI_SYSTEM_DEVICE_MOCK, a comma
+ * separated list of name=value pairs:
+ *
+ *   fail=<n>       calls failing, per mille (0)
+ *   latency=<n>    delay added to every call, in us (0)
+ *   stall=<n>      calls stalling, per mille (0)
+ *   stall_ms=<n>   duration of a stall (1000)
+ *   period=<n>     length of an outage cycle in ms, 0 for no outage (0)
+ *   down=<n>       time the device is down at the end of every cycle, in ms (0)
+ *   seed=<n>       seed of the fault pattern (1)
+ *
+ * Faults apply to every backend call except the vconf registrations. The
+ * random faults of a call depend only on the seed and on the call count,
+ * so a run is reproducible for a given sequence of calls. Outage cycles
+ * start when the backend is selected.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <vconf.h>
+#include <device_private.h>
+
+#define MOCK_BRT_MAX 100
+#define MOCK_LED_MAX 1
+#define MOCK_PERCENT 50
+
+static struct {
+	int fail;
+	int latency;
+	int stall;
+	int stall_ms;
+	int period;
+	int down;
+	int seed;
+} _conf = {
+	.stall_ms = 1000,
+	.seed = 1,
+};
+
+static const struct device_backend_option _options[] = {
+	{ "fail", &_conf.fail },
+	{ "latency", &_conf.latency },
+	{ "stall", &_conf.stall },
+	{ "stall_ms", &_conf.stall_ms },
+	{ "period", &_conf.period },
+	{ "down", &_conf.down },
+	{ "seed", &_conf.seed },
+};
+
+static int _brt[DEVICE_DISPLAY_MAX];
+static int _led;
+static unsigned long long _calls;
+static unsigned long long _start;
+
+/* splitmix64 of the call count, so that concurrent calls need no lock */
+static uint64_t mix(uint64_t x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/* Returns -1 if the call fails */
+static int fault(void)
+{
+	unsigned long long n = __atomic_fetch_add(&_calls, 1, __ATOMIC_RELAXED);
+	uint64_t r = mix(n ^ ((uint64_t)_conf.seed << 32));
+
+	if (_conf.latency > 0)
+		usleep(_conf.latency);
+
+	if (_conf.period > 0 &&
+			(_device_now_us() - _start) / 1000 % _conf.period >= (unsigned long long)(_conf.period - _conf.down))
+		return -1;
+	if ((int)(r % 1000) < _conf.stall)
+		usleep(_conf.stall_ms * 1000);
+	if ((int)((r >> 16) % 1000) < _conf.fail)
+		return -1;
+	return 0;
+}
+
+#define MOCK(value) (fault() < 0 ? -1 : (value))
+
+static int mock_display_count(void)
+{
+	return MOCK(DEVICE_DISPLAY_MAX);
+}
+
+static int mock_display_get_brt(int disp)
+{
+	if (disp < 0 || disp >= DEVICE_DISPLAY_MAX)
+		return -1;
+	return MOCK(__atomic_load_n(&_brt[disp], __ATOMIC_RELAXED));
+}
+
+static int mock_display_set_brt(int disp, int value)
+{
+	if (disp < 0 || disp >= DEVICE_DISPLAY_MAX || fault() < 0)
+		return -1;
+	__atomic_store_n(&_brt[disp], value, __ATOMIC_RELAXED);
+	return 0;
+}
+
+static int mock_display_get_max_brt(int disp)
+{
+	return MOCK(MOCK_BRT_MAX);
+}
+
+static int mock_display_release_brt(int disp)
+{
+	return MOCK(0);
+}
+
+static int mock_battery_get_pct(void)
+{
+	return MOCK(MOCK_PERCENT);
+}
+
+static int mock_battery_get_pct_raw(void)
+{
+	return MOCK(MOCK_PERCENT * 100);
+}
+
+static int mock_battery_is_full(void)
+{
+	return MOCK(0);
+}
+
+static int mock_led_get_brt(void)
+{
+	return MOCK(__atomic_load_n(&_led, __ATOMIC_RELAXED));
+}
+
+static int mock_led_set_brt(int value)
+{
+	if (fault() < 0)
+		return -1;
+	__atomic_store_n(&_led, value, __ATOMIC_RELAXED);
+	return 0;
+}
+
+static int mock_led_get_max(void)
+{
+	return MOCK(MOCK_LED_MAX);
+}
+
+static int mock_vconf_get_int(const char *key, int *value)
+{
+	if (fault() < 0)
+		return -1;
+
+	switch (_device_event_from_key(key)) {
+	case DEVICE_EVENT_BATTERY_CAPACITY:
+		*value = MOCK_PERCENT;
+		return 0;
+	case DEVICE_EVENT_BATTERY_CHARGING:
+		*value = 0;
+		return 0;
+	case DEVICE_EVENT_BATTERY_WARNING:
+		*value = VCONFKEY_SYSMAN_BAT_NORMAL;
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+static int mock_vconf_notify(const char *key, vconf_callback_fn cb, void *data)
+{
+	return 0;
+}
+
+static int mock_vconf_ignore(const char *key, vconf_callback_fn cb)
+{
+	return 0;
+}
+
+static int mock_keynode_get_int(const keynode_t *key)
+{
+	return -1;
+}
+
+static const struct device_backend _mock_backend = {
+	.name = "mock",
+	.display_count = mock_display_count,
+	.display_get_brt = mock_display_get_brt,
+	.display_set_brt = mock_display_set_brt,
+	.display_get_max_brt = mock_display_get_max_brt,
+	.display_release_brt = mock_display_release_brt,
+	.battery_get_pct = mock_battery_get_pct,
+	.battery_get_pct_raw = mock_battery_get_pct_raw,
+	.battery_is_full = mock_battery_is_full,
+	.led_get_brt = mock_led_get_brt,
+	.led_set_brt = mock_led_set_brt,
+	.led_get_max = mock_led_get_max,
+	.vconf_get_int = mock_vconf_get_int,
+	.vconf_notify = mock_vconf_notify,
+	.vconf_ignore = mock_vconf_ignore,
+	.keynode_get_int = mock_keynode_get_int,
+};
+
+const struct device_backend *_device_mock_backend(void)
+{
+	_device_backend_options(secure_getenv("CAPI_SYSTEM_DEVICE_MOCK"), _options, sizeof(_options) / sizeof(_options[0]));
+
+	_start = _device_now_us();
+
+	LOGI("[%s] fail %d, stall %d per mille, latency %dus, down %d of %d ms", __FUNCTION__,
+			_conf.fail, _conf.stall, _conf.latency, _conf.down, _conf.period);
+
+	return &_mock_backend;
+}
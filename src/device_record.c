@@ -0,0 +1,515 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+/*
+ * Backend trace recording and replay.
+ *
+ * CAPI_SYSTEM_DEVICE_RECORD=<path> records every backend call and its
+ * result, and every vconf notification, into a preallocated memory mapped
+ * file of CAPI_SYSTEM_DEVICE_RECORD_SIZE bytes (1MB by default). Records
+ * that do not fit are counted as dropped. The file is created and must
+ * not exist yet, so that an existing file or link is never overwritten.
+ *
+ * CAPI_SYSTEM_DEVICE_BACKEND=replay with CAPI_SYSTEM_DEVICE_TRACE=<path>
+ * feeds a recorded trace back into the library: backend calls return the
+ * recorded results in order, and the recorded notifications are dispatched
+ * from a replay thread at their original time divided by
+ * CAPI_SYSTEM_DEVICE_REPLAY_SPEED (1 by default, 0 for no delay).
+ *
+ * The variables are read with secure_getenv(), a setuid or setgid process
+ * ignores them and runs on devman.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+#define TRACE_MAGIC "DEVTRACE"
+#define TRACE_VERSION 1
+#define TRACE_DEFAULT_SIZE (1024 * 1024)
+
+typedef enum {
+	TRACE_OP_DISPLAY_COUNT,
+	TRACE_OP_DISPLAY_GET_BRT,
+	TRACE_OP_DISPLAY_SET_BRT,
+	TRACE_OP_DISPLAY_GET_MAX_BRT,
+	TRACE_OP_DISPLAY_RELEASE_BRT,
+	TRACE_OP_BATTERY_GET_PCT,
+	TRACE_OP_BATTERY_GET_PCT_RAW,
+	TRACE_OP_BATTERY_IS_FULL,
+	TRACE_OP_LED_GET_BRT,
+	TRACE_OP_LED_SET_BRT,
+	TRACE_OP_LED_GET_MAX,
+	TRACE_OP_VCONF_GET_INT,
+	TRACE_OP_VCONF_NOTIFY,		/* a notification, not a call */
+	TRACE_OP_MAX,
+} trace_op_e;
+
+struct trace_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint32_t capacity;		/* records that fit in the file */
+	uint32_t count;			/* records written */
+	uint32_t dropped;		/* records that did not fit */
+	uint32_t reserved;
+};
+
+struct trace_record {
+	uint64_t time_us;		/* since the start of the recording */
+	uint8_t op;			/* trace_op_e */
+	uint8_t arg;			/* display, or event of the vconf key */
+	uint16_t reserved;
+	int32_t in;			/* value passed to a setter */
+	int32_t ret;			/* return value */
+	int32_t out;			/* value returned through a pointer */
+};
+
+/* Recording */
+
+static const struct device_backend *_inner;
+static struct trace_header *_rec_header;
+static struct trace_record *_rec;
+static uint64_t _rec_start;
+
+static void record(trace_op_e op, int arg, int in, int ret, int out)
+{
+	struct trace_record *r;
+	uint32_t idx;
+
+	if (_rec_header == NULL)
+		return;
+
+	idx = __sync_fetch_and_add(&_rec_header->count, 1);
+	if (idx >= _rec_header->capacity) {
+		__sync_fetch_and_sub(&_rec_header->count, 1);
+		__sync_fetch_and_add(&_rec_header->dropped, 1);
+		return;
+	}
+
+	r = &_rec[idx];
+	r->time_us = _device_now_us() - _rec_start;
+	r->op = op;
+	r->arg = arg;
+	r->in = in;
+	r->ret = ret;
+	r->out = out;
+}
+
+void _device_record_event(device_event_e event, int value)
+{
+	if (__builtin_expect(_rec_header != NULL, 0))
+		record(TRACE_OP_VCONF_NOTIFY, event, 0, 0, value);
+}
+
+#define RECORD_CALL(op, arg, in, call) \
+	do { \
+		int __ret = (call); \
+		record(op, arg, in, __ret, 0); \
+		return __ret; \
+	} while (0)
+
+static int rec_display_count(void)
+{
+	RECORD_CALL(TRACE_OP_DISPLAY_COUNT, 0, 0, _inner->display_count());
+}
+
+static int rec_display_get_brt(int disp)
+{
+	RECORD_CALL(TRACE_OP_DISPLAY_GET_BRT, disp, 0, _inner->display_get_brt(disp));
+}
+
+static int rec_display_set_brt(int disp, int value)
+{
+	RECORD_CALL(TRACE_OP_DISPLAY_SET_BRT, disp, value, _inner->display_set_brt(disp, value));
+}
+
+static int rec_display_get_max_brt(int disp)
+{
+	RECORD_CALL(TRACE_OP_DISPLAY_GET_MAX_BRT, disp, 0, _inner->display_get_max_brt(disp));
+}
+
+static int rec_display_release_brt(int disp)
+{
+	RECORD_CALL(TRACE_OP_DISPLAY_RELEASE_BRT, disp, 0, _inner->display_release_brt(disp));
+}
+
+static int rec_battery_get_pct(void)
+{
+	RECORD_CALL(TRACE_OP_BATTERY_GET_PCT, 0, 0, _inner->battery_get_pct());
+}
+
+static int rec_battery_get_pct_raw(void)
+{
+	RECORD_CALL(TRACE_OP_BATTERY_GET_PCT_RAW, 0, 0, _inner->battery_get_pct_raw());
+}
+
+static int rec_battery_is_full(void)
+{
+	RECORD_CALL(TRACE_OP_BATTERY_IS_FULL, 0, 0, _inner->battery_is_full());
+}
+
+static int rec_led_get_brt(void)
+{
+	RECORD_CALL(TRACE_OP_LED_GET_BRT, 0, 0, _inner->led_get_brt());
+}
+
+static int rec_led_set_brt(int value)
+{
+	RECORD_CALL(TRACE_OP_LED_SET_BRT, 0, value, _inner->led_set_brt(value));
+}
+
+static int rec_led_get_max(void)
+{
+	RECORD_CALL(TRACE_OP_LED_GET_MAX, 0, 0, _inner->led_get_max());
+}
+
+static int rec_vconf_get_int(const char *key, int *value)
+{
+	int ret = _inner->vconf_get_int(key, value);
+	int event = _device_event_from_key(key);
+
+	if (event >= 0)
+		record(TRACE_OP_VCONF_GET_INT, event, 0, ret, ret < 0 ? 0 : *value);
+	return ret;
+}
+
+static int rec_vconf_notify(const char *key, vconf_callback_fn cb, void *data)
+{
+	return _inner->vconf_notify(key, cb, data);
+}
+
+static int rec_vconf_ignore(const char *key, vconf_callback_fn cb)
+{
+	return _inner->vconf_ignore(key, cb);
+}
+
+static int rec_keynode_get_int(const keynode_t *key)
+{
+	return _inner->keynode_get_int(key);
+}
+
+static const struct device_backend _record_backend = {
+	.name = "record",
+	.display_count = rec_display_count,
+	.display_get_brt = rec_display_get_brt,
+	.display_set_brt = rec_display_set_brt,
+	.display_get_max_brt = rec_display_get_max_brt,
+	.display_release_brt = rec_display_release_brt,
+	.battery_get_pct = rec_battery_get_pct,
+	.battery_get_pct_raw = rec_battery_get_pct_raw,
+	.battery_is_full = rec_battery_is_full,
+	.led_get_brt = rec_led_get_brt,
+	.led_set_brt = rec_led_set_brt,
+	.led_get_max = rec_led_get_max,
+	.vconf_get_int = rec_vconf_get_int,
+	.vconf_notify = rec_vconf_notify,
+	.vconf_ignore = rec_vconf_ignore,
+	.keynode_get_int = rec_keynode_get_int,
+};
+
+const struct device_backend *_device_record_backend(const struct device_backend *inner, const char *path)
+{
+	const char *env = secure_getenv("CAPI_SYSTEM_DEVICE_RECORD_SIZE");
+	size_t size = env ? strtoul(env, NULL, 0) : TRACE_DEFAULT_SIZE;
+	void *map;
+	int fd;
+
+	if (size < sizeof(struct trace_header) + sizeof(struct trace_record))
+		size = TRACE_DEFAULT_SIZE;
+
+	fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		LOGE("[%s] fail to create %s : %s", __FUNCTION__, path, strerror(errno));
+		return inner;
+	}
+
+	if (ftruncate(fd, size) < 0) {
+		LOGE("[%s] fail to allocate %s", __FUNCTION__, path);
+		close(fd);
+		return inner;
+	}
+
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		LOGE("[%s] fail to map %s", __FUNCTION__, path);
+		return inner;
+	}
+
+	_inner = inner;
+	_rec = (struct trace_record *)((struct trace_header *)map + 1);
+	_rec_start = _device_now_us();
+
+	memcpy(((struct trace_header *)map)->magic, TRACE_MAGIC, sizeof(((struct trace_header *)map)->magic));
+	((struct trace_header *)map)->version = TRACE_VERSION;
+	((struct trace_header *)map)->record_size = sizeof(struct trace_record);
+	((struct trace_header *)map)->capacity = (size - sizeof(struct trace_header)) / sizeof(struct trace_record);
+	__sync_synchronize();
+	_rec_header = map;
+
+	return &_record_backend;
+}
+
+/* Replay */
+
+static const struct trace_header *_rep_header;
+static const struct trace_record *_rep;
+static uint32_t _rep_cursor[TRACE_OP_MAX][DEVICE_EVENT_MAX > DEVICE_DISPLAY_MAX ? DEVICE_EVENT_MAX : DEVICE_DISPLAY_MAX];
+static pthread_mutex_t _rep_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t _rep_once = PTHREAD_ONCE_INIT;
+static double _rep_speed = 1.0;
+
+/*
+ * Each operation (and display or key) has its own cursor, so the calls
+ * get the recorded results in order even if the replayed application
+ * interleaves them differently. Once a cursor runs out the last recorded
+ * result is repeated.
+ */
+static const struct trace_record *replay_next(trace_op_e op, int arg)
+{
+	const struct trace_record *found = NULL;
+	uint32_t *cursor = &_rep_cursor[op][arg];
+	uint32_t i;
+
+	pthread_mutex_lock(&_rep_lock);
+	for (i = *cursor; i < _rep_header->count; i++) {
+		if (_rep[i].op == op && _rep[i].arg == arg) {
+			found = &_rep[i];
+			*cursor = i + 1;
+			break;
+		}
+	}
+
+	if (found == NULL) {
+		for (i = *cursor; i-- > 0;) {
+			if (_rep[i].op == op && _rep[i].arg == arg) {
+				found = &_rep[i];
+				break;
+			}
+		}
+	}
+	pthread_mutex_unlock(&_rep_lock);
+
+	return found;
+}
+
+#define REPLAY_CALL(op, arg) \
+	do { \
+		const struct trace_record *__r = replay_next(op, arg); \
+		return __r ? __r->ret : -1; \
+	} while (0)
+
+static int rep_display_count(void)
+{
+	REPLAY_CALL(TRACE_OP_DISPLAY_COUNT, 0);
+}
+
+static int rep_display_get_brt(int disp)
+{
+	REPLAY_CALL(TRACE_OP_DISPLAY_GET_BRT, disp);
+}
+
+static int rep_display_set_brt(int disp, int value)
+{
+	REPLAY_CALL(TRACE_OP_DISPLAY_SET_BRT, disp);
+}
+
+static int rep_display_get_max_brt(int disp)
+{
+	REPLAY_CALL(TRACE_OP_DISPLAY_GET_MAX_BRT, disp);
+}
+
+static int rep_display_release_brt(int disp)
+{
+	REPLAY_CALL(TRACE_OP_DISPLAY_RELEASE_BRT, disp);
+}
+
+static int rep_battery_get_pct(void)
+{
+	REPLAY_CALL(TRACE_OP_BATTERY_GET_PCT, 0);
+}
+
+static int rep_battery_get_pct_raw(void)
+{
+	REPLAY_CALL(TRACE_OP_BATTERY_GET_PCT_RAW, 0);
+}
+
+static int rep_battery_is_full(void)
+{
+	REPLAY_CALL(TRACE_OP_BATTERY_IS_FULL, 0);
+}
+
+static int rep_led_get_brt(void)
+{
+	REPLAY_CALL(TRACE_OP_LED_GET_BRT, 0);
+}
+
+static int rep_led_set_brt(int value)
+{
+	REPLAY_CALL(TRACE_OP_LED_SET_BRT, 0);
+}
+
+static int rep_led_get_max(void)
+{
+	REPLAY_CALL(TRACE_OP_LED_GET_MAX, 0);
+}
+
+static int rep_vconf_get_int(const char *key, int *value)
+{
+	const struct trace_record *r;
+	int event = _device_event_from_key(key);
+
+	if (event < 0)
+		return -1;
+
+	r = replay_next(TRACE_OP_VCONF_GET_INT, event);
+	if (r == NULL || r->ret < 0)
+		return -1;
+
+	*value = r->out;
+	return r->ret;
+}
+
+static void *replay_main(void *data)
+{
+	uint64_t start = _device_now_us(), due, now;
+	uint32_t i;
+
+	for (i = 0; i < _rep_header->count; i++) {
+		if (_rep[i].op != TRACE_OP_VCONF_NOTIFY || _rep[i].arg >= DEVICE_EVENT_MAX)
+			continue;
+
+		if (_rep_speed > 0) {
+			due = start + (uint64_t)(_rep[i].time_us / _rep_speed);
+			now = _device_now_us();
+			if (due > now)
+				usleep(due - now);
+		}
+		_device_event_dispatch(_rep[i].arg, _rep[i].out, _device_now_us());
+	}
+
+	LOGI("[%s] replay finished", __FUNCTION__);
+	return NULL;
+}
+
+static void replay_start(void)
+{
+	pthread_t th;
+
+	if (pthread_create(&th, NULL, replay_main, NULL) == 0)
+		pthread_detach(th);
+	else
+		LOGE("[%s] fail to start the replay", __FUNCTION__);
+}
+
+static int rep_vconf_notify(const char *key, vconf_callback_fn cb, void *data)
+{
+	/* notifications are dispatched by the replay thread once someone listens */
+	pthread_once(&_rep_once, replay_start);
+	return 0;
+}
+
+static int rep_vconf_ignore(const char *key, vconf_callback_fn cb)
+{
+	return 0;
+}
+
+static int rep_keynode_get_int(const keynode_t *key)
+{
+	return -1;
+}
+
+static const struct device_backend _replay_backend = {
+	.name = "replay",
+	.display_count = rep_display_count,
+	.display_get_brt = rep_display_get_brt,
+	.display_set_brt = rep_display_set_brt,
+	.display_get_max_brt = rep_display_get_max_brt,
+	.display_release_brt = rep_display_release_brt,
+	.battery_get_pct = rep_battery_get_pct,
+	.battery_get_pct_raw = rep_battery_get_pct_raw,
+	.battery_is_full = rep_battery_is_full,
+	.led_get_brt = rep_led_get_brt,
+	.led_set_brt = rep_led_set_brt,
+	.led_get_max = rep_led_get_max,
+	.vconf_get_int = rep_vconf_get_int,
+	.vconf_notify = rep_vconf_notify,
+	.vconf_ignore = rep_vconf_ignore,
+	.keynode_get_int = rep_keynode_get_int,
+};
+
+const struct device_backend *_device_replay_backend(const char *path)
+{
+	const struct trace_header *header;
+	const char *env = secure_getenv("CAPI_SYSTEM_DEVICE_REPLAY_SPEED");
+	struct stat st;
+	void *map;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+	if (fd < 0) {
+		LOGE("[%s] fail to open %s", __FUNCTION__, path);
+		return NULL;
+	}
+
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct trace_header)) {
+		LOGE("[%s] %s is not a trace", __FUNCTION__, path);
+		close(fd);
+		return NULL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		LOGE("[%s] fail to map %s", __FUNCTION__, path);
+		return NULL;
+	}
+
+	header = map;
+	if (memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) != 0 ||
+			header->version != TRACE_VERSION ||
+			header->record_size != sizeof(struct trace_record) ||
+			header->count > (st.st_size - sizeof(struct trace_header)) / sizeof(struct trace_record)) {
+		LOGE("[%s] %s is not a valid trace", __FUNCTION__, path);
+		munmap(map, st.st_size);
+		return NULL;
+	}
+
+	if (env != NULL)
+		_rep_speed = strtod(env, NULL);
+
+	_rep_header = header;
+	_rep = (const struct trace_record *)(header + 1);
+	LOGI("[%s] replaying %u records from %s (%u dropped)", __FUNCTION__,
+			header->count, path, header->dropped);
+
+	return &_replay_backend;
+}
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+/*
+ * Retries and circuit breakers.
+ *
+ * Wraps the backend outside the deadlines, so a retry never outlives the
+ * deadline of its call and a timed out attempt is not retried. The delay
+ * before retry n is drawn from [d/2, d] with d = base * 2^(n-1), capped.
+ *
+ * Each subsystem has a breaker. It opens after breaker_threshold failed
+ * calls in a row; while open, calls fail without reaching the backend.
+ * Once the cooldown passes, one call probes the backend: success closes
+ * the breaker, failure opens it again for twice the cooldown. A healthy
+ * call costs two atomic loads and an atomic increment, the lock is only
+ * taken on failures and state changes.
+ *
+ * Errors that say the device lacks the operation (-ENODEV and the like)
+ * are final: they are returned at once and count as an answer of the
+ * backend, not as a failure of the subsystem. Threads that must not sleep,
+ * the notification path, the scheduler and the holders of the lease lock,
+ * suspend the retries (_device_retry_suspend()) and fail on the first error.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+#define BREAKER_COOLDOWN_MAX 30000	/* ms */
+
+struct breaker {
+	device_breaker_e state;
+	int failed;				/* failed calls in a row */
+	int probing;
+	unsigned long long open_until;
+	unsigned long long cooldown;	/* us */
+
+	unsigned long long calls;
+	unsigned long long failures;
+	unsigned long long retries;
+	unsigned long long rejected;
+	unsigned long long trips;
+};
+
+static const struct device_backend *_inner;
+static struct breaker _breakers[DEVICE_SUBSYSTEM_MAX];
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+static device_retry_policy_s _policy = {
+	.attempts = 3,
+	.base_delay_ms = 10,
+	.max_delay_ms = 200,
+	.breaker_threshold = 5,
+	.breaker_cooldown_ms = 1000,
+};
+
+static __thread uint32_t _seed;
+static __thread int _suspended;
+
+void _device_retry_suspend(void)
+{
+	_suspended++;
+}
+
+void _device_retry_resume(void)
+{
+	_suspended--;
+}
+
+/* -1 is the generic devman failure and may pass, these will not */
+static int permanent(int ret)
+{
+	return ret == -ENODEV || ret == -ENOENT || ret == -ENOSYS || ret == -EINVAL ||
+			ret == -EACCES || ret == -EOPNOTSUPP;
+}
+
+static uint32_t jitter(void)
+{
+	/* xorshift32, seeded per thread so retrying clients drift apart */
+	if (_seed == 0)
+		_seed = (uint32_t)_device_now_us() ^ (uint32_t)(uintptr_t)&_seed;
+	_seed ^= _seed << 13;
+	_seed ^= _seed >> 17;
+	_seed ^= _seed << 5;
+	return _seed;
+}
+
+static int breaker_enter(device_subsystem_e subsys)
+{
+	struct breaker *b = &_breakers[subsys];
+	unsigned long long now;
+	int ret = 0;
+
+	if (__atomic_load_n(&b->state, __ATOMIC_RELAXED) == DEVICE_BREAKER_CLOSED)
+		return 0;
+
+	now = _device_now_us();
+	pthread_mutex_lock(&_lock);
+	if (b->state == DEVICE_BREAKER_OPEN && now >= b->open_until) {
+		b->state = DEVICE_BREAKER_HALF_OPEN;
+		b->probing = 0;
+	}
+	if (b->state == DEVICE_BREAKER_HALF_OPEN && !b->probing)
+		b->probing = 1;
+	else if (b->state != DEVICE_BREAKER_CLOSED)
+		ret = -1;
+	if (ret < 0)
+		b->rejected++;
+	pthread_mutex_unlock(&_lock);
+
+	return ret;
+}
+
+/* Called with _lock held */
+static void breaker_open(device_subsystem_e subsys, struct breaker *b)
+{
+	unsigned long long cooldown = _policy.breaker_cooldown_ms * 1000ULL;
+	unsigned long long limit = BREAKER_COOLDOWN_MAX * 1000ULL;
+
+	/* A failed probe doubles the cooldown, up to the larger of the limit and the policy */
+	if (b->state == DEVICE_BREAKER_HALF_OPEN && b->cooldown * 2 > cooldown) {
+		if (limit < cooldown)
+			limit = cooldown;
+		cooldown = b->cooldown * 2 < limit ? b->cooldown * 2 : limit;
+	}
+
+	b->state = DEVICE_BREAKER_OPEN;
+	b->probing = 0;
+	b->cooldown = cooldown;
+	b->open_until = _device_now_us() + cooldown;
+	b->trips++;
+	LOGE("[%s] subsystem %d is down, failing its calls for %llums", __FUNCTION__, subsys, cooldown / 1000);
+}
+
+static void breaker_leave(device_subsystem_e subsys, int ok)
+{
+	struct breaker *b = &_breakers[subsys];
+	int threshold;
+
+	__atomic_fetch_add(&b->calls, 1, __ATOMIC_RELAXED);
+	if (ok && __atomic_load_n(&b->failed, __ATOMIC_RELAXED) == 0 &&
+			__atomic_load_n(&b->state, __ATOMIC_RELAXED) == DEVICE_BREAKER_CLOSED)
+		return;
+
+	pthread_mutex_lock(&_lock);
+	if (ok) {
+		if (b->state != DEVICE_BREAKER_CLOSED)
+			LOGI("[%s] subsystem %d is back", __FUNCTION__, subsys);
+		b->failed = 0;
+		b->state = DEVICE_BREAKER_CLOSED;
+		b->probing = 0;
+	} else {
+		b->failures++;
+		b->failed++;
+		threshold = _policy.breaker_threshold;
+		if (b->state == DEVICE_BREAKER_HALF_OPEN || (threshold > 0 && b->failed >= threshold &&
+					b->state == DEVICE_BREAKER_CLOSED))
+			breaker_open(subsys, b);
+	}
+	pthread_mutex_unlock(&_lock);
+}
+
+/* Waits before attempt n + 1 of a failed call; returns 0 if it must not be retried */
+static int retry_wait(device_subsystem_e subsys, int n)
+{
+	unsigned long long delay, deadline;
+	struct timespec ts;
+	int base, max;
+
+	if (_suspended || n >= __atomic_load_n(&_policy.attempts, __ATOMIC_RELAXED) || _device_call_timed_out())
+		return 0;
+
+	base = __atomic_load_n(&_policy.base_delay_ms, __ATOMIC_RELAXED);
+	max = __atomic_load_n(&_policy.max_delay_ms, __ATOMIC_RELAXED);
+	delay = (unsigned long long)base << (n - 1 < 20 ? n - 1 : 20);
+	if (delay > (unsigned long long)max)
+		delay = max;
+	delay *= 1000;
+	delay = delay / 2 + (delay > 1 ? jitter() % (delay / 2 + 1) : 0);
+
+	deadline = _device_call_armed();
+	if (deadline != 0 && _device_now_us() + delay >= deadline)
+		return 0;
+
+	__atomic_fetch_add(&_breakers[subsys].retries, 1, __ATOMIC_RELAXED);
+	ts.tv_sec = delay / 1000000ULL;
+	ts.tv_nsec = (delay % 1000000ULL) * 1000;
+	nanosleep(&ts, NULL);
+	return 1;
+}
+
+#define RETRY(subsys, call) \
+	do { \
+		int __ret, __n = 0; \
+		if (breaker_enter(subsys) < 0) \
+			return -1; \
+		while ((__ret = (call)) < 0 && !permanent(__ret) && retry_wait(subsys, ++__n)) \
+			; \
+		breaker_leave(subsys, __ret >= 0 || permanent(__ret)); \
+		return __ret; \
+	} while (0)
+
+static int retry_display_count(void)
+{
+	RETRY(DEVICE_SUBSYSTEM_DISPLAY, _inner->display_count());
+}
+
+static int retry_display_get_brt(int disp)
+{
+	RETRY(DEVICE_SUBSYSTEM_DISPLAY, _inner->display_get_brt(disp));
+}
+
+static int retry_display_set_brt(int disp, int value)
+{
+	RETRY(DEVICE_SUBSYSTEM_DISPLAY, _inner->display_set_brt(disp, value));
+}
+
+static int retry_display_get_max_brt(int disp)
+{
+	RETRY(DEVICE_SUBSYSTEM_DISPLAY, _inner->display_get_max_brt(disp));
+}
+
+static int retry_display_release_brt(int disp)
+{
+	RETRY(DEVICE_SUBSYSTEM_DISPLAY, _inner->display_release_brt(disp));
+}
+
+static int retry_battery_get_pct(void)
+{
+	RETRY(DEVICE_SUBSYSTEM_BATTERY, _inner->battery_get_pct());
+}
+
+static int retry_battery_get_pct_raw(void)
+{
+	RETRY(DEVICE_SUBSYSTEM_BATTERY, _inner->battery_get_pct_raw());
+}
+
+static int retry_battery_is_full(void)
+{
+	RETRY(DEVICE_SUBSYSTEM_BATTERY, _inner->battery_is_full());
+}
+
+static int retry_led_get_brt(void)
+{
+	RETRY(DEVICE_SUBSYSTEM_FLASH, _inner->led_get_brt());
+}
+
+static int retry_led_set_brt(int value)
+{
+	RETRY(DEVICE_SUBSYSTEM_FLASH, _inner->led_set_brt(value));
+}
+
+static int retry_led_get_max(void)
+{
+	RETRY(DEVICE_SUBSYSTEM_FLASH, _inner->led_get_max());
+}
+
+static int retry_vconf_get_int(const char *key, int *value)
+{
+	RETRY(DEVICE_SUBSYSTEM_SETTINGS, _inner->vconf_get_int(key, value));
+}
+
+static int retry_vconf_notify(const char *key, vconf_callback_fn cb, void *data)
+{
+	return _inner->vconf_notify(key, cb, data);
+}
+
+static int retry_vconf_ignore(const char *key, vconf_callback_fn cb)
+{
+	return _inner->vconf_ignore(key, cb);
+}
+
+static int retry_keynode_get_int(const keynode_t *key)
+{
+	return _inner->keynode_get_int(key);
+}
+
+static struct device_backend _retry_backend = {
+	.display_count = retry_display_count,
+	.display_get_brt = retry_display_get_brt,
+	.display_set_brt = retry_display_set_brt,
+	.display_get_max_brt = retry_display_get_max_brt,
+	.display_release_brt = retry_display_release_brt,
+	.battery_get_pct = retry_battery_get_pct,
+	.battery_get_pct_raw = retry_battery_get_pct_raw,
+	.battery_is_full = retry_battery_is_full,
+	.led_get_brt = retry_led_get_brt,
+	.led_set_brt = retry_led_set_brt,
+	.led_get_max = retry_led_get_max,
+	.vconf_get_int = retry_vconf_get_int,
+	.vconf_notify = retry_vconf_notify,
+	.vconf_ignore = retry_vconf_ignore,
+	.keynode_get_int = retry_keynode_get_int,
+};
+
+const struct device_backend *_device_retry_backend(const struct device_backend *inner)
+{
+	_inner = inner;
+	_retry_backend.name = inner->name;
+	return &_retry_backend;
+}
+
+int device_set_retry_policy(const device_retry_policy_s *policy)
+{
+	if (policy == NULL || policy->attempts < 1 || policy->base_delay_ms < 0 ||
+			policy->max_delay_ms < policy->base_delay_ms ||
+			policy->breaker_threshold < 0 || policy->breaker_cooldown_ms < 0)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	pthread_mutex_lock(&_lock);
+	__atomic_store_n(&_policy.attempts, policy->attempts, __ATOMIC_RELAXED);
+	__atomic_store_n(&_policy.base_delay_ms, policy->base_delay_ms, __ATOMIC_RELAXED);
+	__atomic_store_n(&_policy.max_delay_ms, policy->max_delay_ms, __ATOMIC_RELAXED);
+	__atomic_store_n(&_policy.breaker_threshold, policy->breaker_threshold, __ATOMIC_RELAXED);
+	__atomic_store_n(&_policy.breaker_cooldown_ms, policy->breaker_cooldown_ms, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&_lock);
+
+	return DEVICE_ERROR_NONE;
+}
+
+int device_get_retry_policy(device_retry_policy_s *policy)
+{
+	if (policy == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	pthread_mutex_lock(&_lock);
+	*policy = _policy;
+	pthread_mutex_unlock(&_lock);
+
+	return DEVICE_ERROR_NONE;
+}
+
+int device_subsystem_get_stats(device_subsystem_e subsystem, device_subsystem_stats_s *stats)
+{
+	struct breaker *b;
+
+	if (subsystem < 0 || subsystem >= DEVICE_SUBSYSTEM_MAX || stats == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	b = &_breakers[subsystem];
+	pthread_mutex_lock(&_lock);
+	stats->calls = __atomic_load_n(&b->calls, __ATOMIC_RELAXED);
+	stats->failures = b->failures;
+	stats->retries = __atomic_load_n(&b->retries, __ATOMIC_RELAXED);
+	stats->rejected = b->rejected;
+	stats->trips = b->trips;
+	stats->breaker = b->state;
+	pthread_mutex_unlock(&_lock);
+
+	return DEVICE_ERROR_NONE;
+}
+
+int device_subsystem_reset_stats(device_subsystem_e subsystem)
+{
+	struct breaker *b;
+
+	if (subsystem < 0 || subsystem >= DEVICE_SUBSYSTEM_MAX)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	b = &_breakers[subsystem];
+	pthread_mutex_lock(&_lock);
+	__atomic_store_n(&b->calls, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&b->retries, 0, __ATOMIC_RELAXED);
+	b->failures = 0;
+	b->rejected = 0;
+	b->trips = 0;
+	pthread_mutex_unlock(&_lock);
+
+	return DEVICE_ERROR_NONE;
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+#define SCHED_TASK_MAX 16
+#define SCHED_SLACK_DEFAULT 50	/* ms */
+
+/*
+ * Every periodic backend read of the library runs from this scheduler: one
+ * thread, one timerfd armed for the earliest deadline of a min-heap. Tasks
+ * due within the slack of the earliest one run in the same wakeup, so
+ * periodic work of unrelated features shares wakeups instead of adding its
+ * own. The slack is set with CAPI_SYSTEM_DEVICE_SCHED_SLACK in milliseconds.
+ */
+static struct device_sched_task *_heap[SCHED_TASK_MAX];
+static int _count;
+static int _fd = -1;
+static unsigned long long _slack;
+
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+static void heap_swap(int a, int b)
+{
+	struct device_sched_task *t = _heap[a];
+
+	_heap[a] = _heap[b];
+	_heap[b] = t;
+	_heap[a]->index = a;
+	_heap[b]->index = b;
+}
+
+static void heap_up(int i)
+{
+	while (i > 0 && _heap[(i - 1) / 2]->deadline > _heap[i]->deadline) {
+		heap_swap(i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+static void heap_down(int i)
+{
+	int min, l, r;
+
+	for (;;) {
+		l = 2 * i + 1;
+		r = l + 1;
+		min = i;
+		if (l < _count && _heap[l]->deadline < _heap[min]->deadline)
+			min = l;
+		if (r < _count && _heap[r]->deadline < _heap[min]->deadline)
+			min = r;
+		if (min == i)
+			return;
+		heap_swap(i, min);
+		i = min;
+	}
+}
+
+static void heap_remove(struct device_sched_task *task)
+{
+	int i = task->index;
+
+	task->index = -1;
+	if (--_count == i)
+		return;
+
+	_heap[i] = _heap[_count];
+	_heap[i]->index = i;
+	heap_up(i);
+	heap_down(_heap[i]->index);
+}
+
+static int heap_insert(struct device_sched_task *task)
+{
+	if (_count == SCHED_TASK_MAX)
+		return -1;
+
+	task->index = _count;
+	_heap[_count++] = task;
+	heap_up(task->index);
+	return 0;
+}
+
+/* Called with _lock held, after every change of the heap top */
+static void arm(void)
+{
+	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+	unsigned long long deadline;
+
+	if (_count > 0) {
+		/* An it_value of zero disarms, a deadline already passed must still fire */
+		deadline = _heap[0]->deadline ? _heap[0]->deadline : 1;
+		its.it_value.tv_sec = deadline / 1000000ULL;
+		its.it_value.tv_nsec = (deadline % 1000000ULL) * 1000;
+	}
+	timerfd_settime(_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static void *sched_main(void *data)
+{
+	struct device_sched_task *due[SCHED_TASK_MAX];
+	unsigned long long now, next;
+	uint64_t expirations;
+	int i, n;
+
+	/* Tasks poll again on their next deadline, a retry delay would only hold back the others */
+	_device_retry_suspend();
+
+	for (;;) {
+		if (read(_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN && errno != EINTR) {
+			LOGE("[%s] fail to read the timer (%d)", __FUNCTION__, errno);
+			return NULL;
+		}
+
+		now = _device_now_us();
+		n = 0;
+		pthread_mutex_lock(&_lock);
+		while (_count > 0 && _heap[0]->deadline <= now + _slack) {
+			due[n] = _heap[0];
+			due[n]->running = 1;
+			heap_remove(due[n]);
+			n++;
+		}
+		pthread_mutex_unlock(&_lock);
+
+		for (i = 0; i < n; i++) {
+			next = due[i]->func(due[i], now);
+
+			pthread_mutex_lock(&_lock);
+			due[i]->running = 0;
+			if (due[i]->active && next != 0) {
+				/* Rescheduled from inside the callback, keep the earlier deadline */
+				if (due[i]->index >= 0) {
+					if (next < due[i]->deadline) {
+						due[i]->deadline = next;
+						heap_up(due[i]->index);
+					}
+				} else {
+					due[i]->deadline = next;
+					heap_insert(due[i]);
+				}
+			} else if (due[i]->index < 0) {
+				due[i]->active = 0;
+			}
+			pthread_mutex_unlock(&_lock);
+		}
+
+		pthread_mutex_lock(&_lock);
+		arm();
+		pthread_mutex_unlock(&_lock);
+	}
+	return NULL;
+}
+
+static void sched_start(void)
+{
+	const char *env = secure_getenv("CAPI_SYSTEM_DEVICE_SCHED_SLACK");
+	pthread_t th;
+	int fd;
+
+	_slack = (env ? strtoull(env, NULL, 10) : SCHED_SLACK_DEFAULT) * 1000ULL;
+
+	fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (fd < 0) {
+		LOGE("[%s] fail to create the timer (%d)", __FUNCTION__, errno);
+		return;
+	}
+	_fd = fd;
+
+	if (pthread_create(&th, NULL, sched_main, NULL) != 0) {
+		LOGE("[%s] fail to start the scheduler thread", __FUNCTION__);
+		close(fd);
+		_fd = -1;
+		return;
+	}
+	pthread_detach(th);
+}
+
+int _device_sched_add(struct device_sched_task *task, unsigned long long deadline)
+{
+	int ret = 0;
+
+	pthread_once(&_once, sched_start);
+	if (_fd < 0)
+		return -1;
+
+	pthread_mutex_lock(&_lock);
+	if (!task->active && !task->running)
+		task->index = -1;
+	task->active = 1;
+
+	if (task->index >= 0) {
+		task->deadline = deadline;
+		heap_up(task->index);
+		heap_down(task->index);
+	} else {
+		task->deadline = deadline;
+		ret = heap_insert(task);
+		if (ret < 0) {
+			task->active = 0;
+			LOGE("[%s] too many scheduled tasks", __FUNCTION__);
+		}
+	}
+
+	if (ret == 0 && _heap[0] == task)
+		arm();
+	pthread_mutex_unlock(&_lock);
+
+	return ret;
+}
+
+void _device_sched_cancel(struct device_sched_task *task)
+{
+	pthread_mutex_lock(&_lock);
+	if (task->active && task->index >= 0) {
+		heap_remove(task);
+		arm();
+	}
+	task->active = 0;
+	pthread_mutex_unlock(&_lock);
+}
+
+unsigned long long _device_sched_backoff(struct device_sched_task *task, int changed, unsigned long long now)
+{
+	if (changed || task->period < task->period_min)
+		task->period = task->period_min;
+	else if (task->period < task->period_max / 2)
+		task->period *= 2;
+	else
+		task->period = task->period_max;
+
+	return now + task->period;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+#include <device_simd_private.h>
+
+#define SERIES_INITIAL 1024
+#define MS_PER_HOUR 3600000.0
+
+/* Structure of arrays, one column per quantity */
+struct _device_battery_series_s {
+	int count;
+	int capacity;
+	int64_t *time;
+	int32_t *percent;
+	int32_t *detail;
+};
+
+static int series_grow(struct _device_battery_series_s *s)
+{
+	int capacity = s->capacity ? s->capacity * 2 : SERIES_INITIAL;
+	void *p;
+
+	if ((p = realloc(s->time, capacity * sizeof(*s->time))) == NULL)
+		return -1;
+	s->time = p;
+	if ((p = realloc(s->percent, capacity * sizeof(*s->percent))) == NULL)
+		return -1;
+	s->percent = p;
+	if ((p = realloc(s->detail, capacity * sizeof(*s->detail))) == NULL)
+		return -1;
+	s->detail = p;
+
+	s->capacity = capacity;
+	return 0;
+}
+
+static bool series_append(const device_battery_sample_s *sample, void *user_data)
+{
+	struct _device_battery_series_s *s = user_data;
+
+	if (s->count == s->capacity && series_grow(s) < 0) {
+		s->capacity = -1;
+		return false;
+	}
+
+	s->time[s->count] = sample->time;
+	s->percent[s->count] = sample->percent;
+	s->detail[s->count] = sample->detail;
+	s->count++;
+	return true;
+}
+
+/* A sample and its position in the file, which orders samples of equal time */
+struct series_row {
+	int64_t time;
+	int32_t percent;
+	int32_t detail;
+	int index;
+};
+
+static int series_row_cmp(const void *a, const void *b)
+{
+	const struct series_row *x = a, *y = b;
+
+	if (x->time != y->time)
+		return x->time < y->time ? -1 : 1;
+	return x->index - y->index;
+}
+
+/* History follows the wall clock, which can step back; get_index() needs the times sorted */
+static int series_sort(struct _device_battery_series_s *s)
+{
+	struct series_row *rows;
+	int i;
+
+	for (i = 1; i < s->count; i++) {
+		if (s->time[i] < s->time[i - 1])
+			break;
+	}
+	if (i >= s->count)
+		return 0;
+
+	rows = malloc(s->count * sizeof(*rows));
+	if (rows == NULL)
+		return -1;
+
+	for (i = 0; i < s->count; i++) {
+		rows[i].time = s->time[i];
+		rows[i].percent = s->percent[i];
+		rows[i].detail = s->detail[i];
+		rows[i].index = i;
+	}
+	qsort(rows, s->count, sizeof(*rows), series_row_cmp);
+	for (i = 0; i < s->count; i++) {
+		s->time[i] = rows[i].time;
+		s->percent[i] = rows[i].percent;
+		s->detail[i] = rows[i].detail;
+	}
+
+	free(rows);
+	return 0;
+}
+
+int device_battery_series_create(const char *path, unsigned long long from, unsigned long long to,
+		device_battery_series_h *series)
+{
+	struct _device_battery_series_s *s;
+	int ret;
+
+	if (path == NULL || series == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	s = calloc(1, sizeof(*s));
+	if (s == NULL)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	ret = device_battery_history_foreach(path, from, to, series_append, s);
+	if (ret == DEVICE_ERROR_NONE && (s->capacity < 0 || series_sort(s) < 0))
+		ret = DEVICE_ERROR_OPERATION_FAILED;
+	if (ret != DEVICE_ERROR_NONE) {
+		device_battery_series_destroy(s);
+		return ret;
+	}
+
+	*series = s;
+	return DEVICE_ERROR_NONE;
+}
+
+int device_battery_series_destroy(device_battery_series_h series)
+{
+	if (series == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	free(series->time);
+	free(series->percent);
+	free(series->detail);
+	free(series);
+	return DEVICE_ERROR_NONE;
+}
+
+int device_battery_series_get_count(device_battery_series_h series, int *count)
+{
+	if (series == NULL || count == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	*count = series->count;
+	return DEVICE_ERROR_NONE;
+}
+
+int device_battery_series_get_index(device_battery_series_h series, unsigned long long time, int *index)
+{
+	int lo, hi, mid;
+
+	if (series == NULL || index == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	lo = 0;
+	hi = series->count;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if ((unsigned long long)series->time[mid] < time)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	*index = lo;
+	return DEVICE_ERROR_NONE;
+}
+
+int device_battery_series_aggregate(device_battery_series_h series, device_battery_series_e column,
+		int index, int count, device_battery_aggregate_s *result)
+{
+	const struct device_kernels *k = _device_kernels();
+	struct device_moments m = { 0, };
+	const int32_t *v;
+	int32_t min, max;
+	double n, den;
+
+	if (series == NULL || result == NULL || count <= 0 || index < 0 || index > series->count - count)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	if (column == DEVICE_BATTERY_SERIES_PERCENT)
+		v = series->percent + index;
+	else if (column == DEVICE_BATTERY_SERIES_DETAIL)
+		v = series->detail + index;
+	else
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	k->minmax(v, count, &min, &max);
+	/* History keeps -1 for a detail the device could not read, it is no value to aggregate */
+	if (column == DEVICE_BATTERY_SERIES_DETAIL && min < 0)
+		RETURN_ERR(DEVICE_ERROR_NOT_SUPPORTED);
+	/* Times relative to the window start keep the sums well conditioned */
+	k->moments(series->time + index, v, count, series->time[index], &m);
+
+	n = count;
+	result->count = count;
+	result->min = min;
+	result->max = max;
+	result->mean = m.sy / n;
+	result->variance = m.syy / n - result->mean * result->mean;
+	if (result->variance < 0)
+		result->variance = 0;
+
+	den = n * m.sxx - m.sx * m.sx;
+	result->rate = den > 0 ? (n * m.sxy - m.sx * m.sy) / den * MS_PER_HOUR : 0;
+
+	return DEVICE_ERROR_NONE;
+}
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+/*
+ * Simulated device, selected with CAPI_SYSTEM_DEVICE_BACKEND=sim.
+ *
+ * The model is configured with CAPI_SYSTEM_DEVICE_SIM, a comma separated
+ * list of name=value pairs:
+ *
+ *   rate=<n>       model steps per second (10)
+ *   steps=<n>      stop after n steps, 0 runs forever (0)
+ *   detail=<n>     initial charge as a per ten thousand (10000)
+ *   discharge=<n>  charge lost per step while on battery (10)
+ *   charge=<n>     charge gained per step while on the charger (25)
+ *   plug=<n>       steps spent on the charger, 0 never plugs (0)
+ *   unplug=<n>     steps spent on battery between two plugs (1000)
+ *   hotplug=<n>    steps between sub display plug and unplug, 0 never (0)
+ *   flood=<0|1>    notify the capacity on every step, even if unchanged (0)
+ *
+ * The model steps from a simulator thread that starts when the library
+ * first subscribes to a notification. Capacity, charging and warning
+ * changes are dispatched straight into the notification path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <vconf.h>
+#include <device_private.h>
+
+#define SIM_DETAIL_MAX 10000
+#define SIM_BRT_MAX 100
+#define SIM_LED_MAX 1
+
+static struct {
+	int rate;
+	int steps;
+	int detail;
+	int discharge;
+	int charge;
+	int plug;
+	int unplug;
+	int hotplug;
+	int flood;
+} _conf = {
+	.rate = 10,
+	.detail = SIM_DETAIL_MAX,
+	.discharge = 10,
+	.charge = 25,
+	.unplug = 1000,
+};
+
+static struct {
+	int detail;
+	int charging;
+	int warning;
+	int displays;
+	int brt[DEVICE_DISPLAY_MAX];
+	int led;
+} _model;
+
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+static int model_percent(void)
+{
+	return _model.detail / (SIM_DETAIL_MAX / 100);
+}
+
+static int model_warning(int percent, int charging)
+{
+	if (percent >= 100 && charging)
+		return VCONFKEY_SYSMAN_BAT_FULL;
+	if (percent <= 1)
+		return VCONFKEY_SYSMAN_BAT_POWER_OFF;
+	if (percent <= 5)
+		return VCONFKEY_SYSMAN_BAT_CRITICAL_LOW;
+	if (percent <= 15)
+		return VCONFKEY_SYSMAN_BAT_WARNING_LOW;
+	return VCONFKEY_SYSMAN_BAT_NORMAL;
+}
+
+static void model_step(int step, int *changed)
+{
+	int period = _conf.plug + _conf.unplug;
+	int percent = model_percent();
+	int charging, warning;
+
+	charging = (_conf.plug > 0 && period > 0) ? (step % period) >= _conf.unplug : 0;
+
+	if (charging)
+		_model.detail += _conf.charge;
+	else
+		_model.detail -= _conf.discharge;
+
+	if (_model.detail > SIM_DETAIL_MAX)
+		_model.detail = SIM_DETAIL_MAX;
+	if (_model.detail < 0)
+		_model.detail = 0;
+
+	warning = model_warning(model_percent(), charging);
+
+	changed[DEVICE_EVENT_BATTERY_CAPACITY] = _conf.flood || percent != model_percent();
+	changed[DEVICE_EVENT_BATTERY_CHARGING] = charging != _model.charging;
+	changed[DEVICE_EVENT_BATTERY_WARNING] = warning != _model.warning;
+	_model.charging = charging;
+	_model.warning = warning;
+
+	if (_conf.hotplug > 0 && step > 0 && step % _conf.hotplug == 0)
+		_model.displays = (_model.displays == 1) ? DEVICE_DISPLAY_MAX : 1;
+}
+
+static void *sim_main(void *data)
+{
+	struct timespec next;
+	long period_ns = 1000000000L / _conf.rate;
+	unsigned long long events = 0;
+	int changed[DEVICE_EVENT_MAX];
+	int values[DEVICE_EVENT_MAX];
+	int step, i;
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	for (step = 0; _conf.steps == 0 || step < _conf.steps; step++) {
+		pthread_mutex_lock(&_lock);
+		model_step(step, changed);
+		values[DEVICE_EVENT_BATTERY_CAPACITY] = model_percent();
+		values[DEVICE_EVENT_BATTERY_CHARGING] = _model.charging;
+		values[DEVICE_EVENT_BATTERY_WARNING] = _model.warning;
+		pthread_mutex_unlock(&_lock);
+
+		for (i = 0; i < DEVICE_EVENT_MAX; i++) {
+			if (changed[i]) {
+				_device_event_dispatch(i, values[i], _device_now_us());
+				events++;
+			}
+		}
+
+		next.tv_nsec += period_ns;
+		while (next.tv_nsec >= 1000000000L) {
+			next.tv_nsec -= 1000000000L;
+			next.tv_sec++;
+		}
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+			;
+	}
+
+	LOGI("[%s] simulation finished after %d steps, %llu events", __FUNCTION__, step, events);
+	return NULL;
+}
+
+static void sim_start(void)
+{
+	pthread_t th;
+
+	if (pthread_create(&th, NULL, sim_main, NULL) == 0)
+		pthread_detach(th);
+	else
+		LOGE("[%s] fail to start the simulation", __FUNCTION__);
+}
+
+static int sim_display_count(void)
+{
+	int count;
+
+	pthread_mutex_lock(&_lock);
+	count = _model.displays;
+	pthread_mutex_unlock(&_lock);
+	return count;
+}
+
+static int sim_display_get_brt(int disp)
+{
+	int value;
+
+	if (disp < 0 || disp >= DEVICE_DISPLAY_MAX)
+		return -1;
+
+	pthread_mutex_lock(&_lock);
+	value = _model.brt[disp];
+	pthread_mutex_unlock(&_lock);
+	return value;
+}
+
+static int sim_display_set_brt(int disp, int value)
+{
+	if (disp < 0 || disp >= DEVICE_DISPLAY_MAX)
+		return -1;
+
+	pthread_mutex_lock(&_lock);
+	_model.brt[disp] = value;
+	pthread_mutex_unlock(&_lock);
+	return 0;
+}
+
+static int sim_display_get_max_brt(int disp)
+{
+	return SIM_BRT_MAX;
+}
+
+static int sim_display_release_brt(int disp)
+{
+	return 0;
+}
+
+static int sim_battery_get_pct(void)
+{
+	int value;
+
+	pthread_mutex_lock(&_lock);
+	value = model_percent();
+	pthread_mutex_unlock(&_lock);
+	return value;
+}
+
+static int sim_battery_get_pct_raw(void)
+{
+	int value;
+
+	pthread_mutex_lock(&_lock);
+	value = _model.detail;
+	pthread_mutex_unlock(&_lock);
+	return value;
+}
+
+static int sim_battery_is_full(void)
+{
+	return sim_battery_get_pct_raw() >= SIM_DETAIL_MAX;
+}
+
+static int sim_led_get_brt(void)
+{
+	int value;
+
+	pthread_mutex_lock(&_lock);
+	value = _model.led;
+	pthread_mutex_unlock(&_lock);
+	return value;
+}
+
+static int sim_led_set_brt(int value)
+{
+	pthread_mutex_lock(&_lock);
+	_model.led = value;
+	pthread_mutex_unlock(&_lock);
+	return 0;
+}
+
+static int sim_led_get_max(void)
+{
+	return SIM_LED_MAX;
+}
+
+static int sim_vconf_get_int(const char *key, int *value)
+{
+	int ret = 0;
+
+	pthread_mutex_lock(&_lock);
+	switch (_device_event_from_key(key)) {
+	case DEVICE_EVENT_BATTERY_CAPACITY:
+		*value = model_percent();
+		break;
+	case DEVICE_EVENT_BATTERY_CHARGING:
+		*value = _model.charging;
+		break;
+	case DEVICE_EVENT_BATTERY_WARNING:
+		*value = _model.warning;
+		break;
+	default:
+		ret = -1;
+		break;
+	}
+	pthread_mutex_unlock(&_lock);
+	return ret;
+}
+
+static int sim_vconf_notify(const char *key, vconf_callback_fn cb, void *data)
+{
+	pthread_once(&_once, sim_start);
+	return 0;
+}
+
+static int sim_vconf_ignore(const char *key, vconf_callback_fn cb)
+{
+	return 0;
+}
+
+static int sim_keynode_get_int(const keynode_t *key)
+{
+	return -1;
+}
+
+static const struct device_backend _sim_backend = {
+	.name = "sim",
+	.display_count = sim_display_count,
+	.display_get_brt = sim_display_get_brt,
+	.display_set_brt = sim_display_set_brt,
+	.display_get_max_brt = sim_display_get_max_brt,
+	.display_release_brt = sim_display_release_brt,
+	.battery_get_pct = sim_battery_get_pct,
+	.battery_get_pct_raw = sim_battery_get_pct_raw,
+	.battery_is_full = sim_battery_is_full,
+	.led_get_brt = sim_led_get_brt,
+	.led_set_brt = sim_led_set_brt,
+	.led_get_max = sim_led_get_max,
+	.vconf_get_int = sim_vconf_get_int,
+	.vconf_notify = sim_vconf_notify,
+	.vconf_ignore = sim_vconf_ignore,
+	.keynode_get_int = sim_keynode_get_int,
+};
+
+static const struct device_backend_option _options[] = {
+	{ "rate", &_conf.rate },
+	{ "steps", &_conf.steps },
+	{ "detail", &_conf.detail },
+	{ "discharge", &_conf.discharge },
+	{ "charge", &_conf.charge },
+	{ "plug", &_conf.plug },
+	{ "unplug", &_conf.unplug },
+	{ "hotplug", &_conf.hotplug },
+	{ "flood", &_conf.flood },
+};
+
+const struct device_backend *_device_sim_backend(void)
+{
+	_device_backend_options(secure_getenv("CAPI_SYSTEM_DEVICE_SIM"), _options, sizeof(_options) / sizeof(_options[0]));
+
+	if (_conf.rate <= 0)
+		_conf.rate = 1;
+	if (_conf.detail < 0 || _conf.detail > SIM_DETAIL_MAX)
+		_conf.detail = SIM_DETAIL_MAX;
+
+	_model.detail = _conf.detail;
+	_model.charging = (_conf.plug > 0 && _conf.unplug == 0);
+	_model.warning = model_warning(model_percent(), _model.charging);
+	_model.displays = 1;
+
+	LOGI("[%s] %d steps/s, detail %d, -%d/+%d per step", __FUNCTION__,
+			_conf.rate, _conf.detail, _conf.discharge, _conf.charge);
+
+	return &_sim_backend;
+}
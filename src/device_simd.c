@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+/*
+ * Aggregation kernels of the battery series.
+ *
+ * Every target gets the scalar kernels. x86 adds SSE2 and AVX2 versions
+ * built with function target attributes and picked at runtime from the
+ * CPU features, so the library itself needs no extra compiler flags.
+ * ARM adds NEON versions when the compiler targets NEON; the moments
+ * need double lanes, so on 32 bit ARM only the min/max is vectorized.
+ *
+ * Times are converted from int64 to double by adding them to the
+ * mantissa of 1.5 * 2^52, exact for |x| < 2^51, since SSE2 and AVX2 have
+ * no 64 bit integer conversion.
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <device_simd_private.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SIMD_NEON
+#endif
+
+#define MAGIC_BITS 0x4338000000000000LL
+#define MAGIC 6755399441055744.0	/* 1.5 * 2^52 */
+
+static void scalar_minmax(const int32_t *v, int n, int32_t *min, int32_t *max)
+{
+	int32_t lo = v[0], hi = v[0];
+	int i;
+
+	for (i = 1; i < n; i++) {
+		if (v[i] < lo)
+			lo = v[i];
+		if (v[i] > hi)
+			hi = v[i];
+	}
+	*min = lo;
+	*max = hi;
+}
+
+static void scalar_moments(const int64_t *t, const int32_t *v, int n, int64_t t0, struct device_moments *m)
+{
+	double x, y;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		x = (double)(t[i] - t0);
+		y = v[i];
+		m->sx += x;
+		m->sxx += x * x;
+		m->sy += y;
+		m->syy += y * y;
+		m->sxy += x * y;
+	}
+}
+
+static const struct device_kernels _scalar = {
+	.name = "scalar",
+	.minmax = scalar_minmax,
+	.moments = scalar_moments,
+};
+
+/* Folds the lanes of a vector min/max with the scalar tail */
+static void fold(const int32_t *lo, const int32_t *hi, int lanes,
+		const int32_t *tail, int n, int32_t *min, int32_t *max)
+{
+	int32_t a, b;
+	int i;
+
+	a = lo[0];
+	b = hi[0];
+	for (i = 1; i < lanes; i++) {
+		if (lo[i] < a)
+			a = lo[i];
+		if (hi[i] > b)
+			b = hi[i];
+	}
+	if (n > 0) {
+		scalar_minmax(tail, n, min, max);
+		if (*min < a)
+			a = *min;
+		if (*max > b)
+			b = *max;
+	}
+	*min = a;
+	*max = b;
+}
+
+#ifdef SIMD_X86
+
+__attribute__((target("sse2")))
+static void sse2_minmax(const int32_t *v, int n, int32_t *min, int32_t *max)
+{
+	int32_t lo[4] __attribute__((aligned(16))), hi[4] __attribute__((aligned(16)));
+	__m128i vlo, vhi, x, gt;
+	int i;
+
+	if (n < 4) {
+		scalar_minmax(v, n, min, max);
+		return;
+	}
+
+	vlo = vhi = _mm_loadu_si128((const __m128i *)v);
+	for (i = 4; i + 4 <= n; i += 4) {
+		x = _mm_loadu_si128((const __m128i *)(v + i));
+		/* SSE2 has no 32 bit min/max, select through a compare mask */
+		gt = _mm_cmpgt_epi32(vlo, x);
+		vlo = _mm_or_si128(_mm_and_si128(gt, x), _mm_andnot_si128(gt, vlo));
+		gt = _mm_cmpgt_epi32(x, vhi);
+		vhi = _mm_or_si128(_mm_and_si128(gt, x), _mm_andnot_si128(gt, vhi));
+	}
+	_mm_store_si128((__m128i *)lo, vlo);
+	_mm_store_si128((__m128i *)hi, vhi);
+	fold(lo, hi, 4, v + i, n - i, min, max);
+}
+
+__attribute__((target("sse2")))
+static void sse2_moments(const int64_t *t, const int32_t *v, int n, int64_t t0, struct device_moments *m)
+{
+	double r[5][2] __attribute__((aligned(16)));
+	const __m128i base = _mm_set1_epi64x(MAGIC_BITS - t0);
+	const __m128d magic = _mm_set1_pd(MAGIC);
+	__m128d sx, sxx, sy, syy, sxy, x, y;
+	int i;
+
+	sx = sxx = sy = syy = sxy = _mm_setzero_pd();
+	for (i = 0; i + 2 <= n; i += 2) {
+		x = _mm_sub_pd(_mm_castsi128_pd(_mm_add_epi64(_mm_loadu_si128((const __m128i *)(t + i)), base)), magic);
+		y = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i *)(v + i)));
+		sx = _mm_add_pd(sx, x);
+		sxx = _mm_add_pd(sxx, _mm_mul_pd(x, x));
+		sy = _mm_add_pd(sy, y);
+		syy = _mm_add_pd(syy, _mm_mul_pd(y, y));
+		sxy = _mm_add_pd(sxy, _mm_mul_pd(x, y));
+	}
+	_mm_store_pd(r[0], sx);
+	_mm_store_pd(r[1], sxx);
+	_mm_store_pd(r[2], sy);
+	_mm_store_pd(r[3], syy);
+	_mm_store_pd(r[4], sxy);
+	m->sx += r[0][0] + r[0][1];
+	m->sxx += r[1][0] + r[1][1];
+	m->sy += r[2][0] + r[2][1];
+	m->syy += r[3][0] + r[3][1];
+	m->sxy += r[4][0] + r[4][1];
+
+	scalar_moments(t + i, v + i, n - i, t0, m);
+}
+
+static const struct device_kernels _sse2 = {
+	.name = "sse2",
+	.minmax = sse2_minmax,
+	.moments = sse2_moments,
+};
+
+__attribute__((target("avx2")))
+static void avx2_minmax(const int32_t *v, int n, int32_t *min, int32_t *max)
+{
+	int32_t lo[8] __attribute__((aligned(32))), hi[8] __attribute__((aligned(32)));
+	__m256i vlo, vhi, x;
+	int i;
+
+	if (n < 8) {
+		scalar_minmax(v, n, min, max);
+		return;
+	}
+
+	vlo = vhi = _mm256_loadu_si256((const __m256i *)v);
+	for (i = 8; i + 8 <= n; i += 8) {
+		x = _mm256_loadu_si256((const __m256i *)(v + i));
+		vlo = _mm256_min_epi32(vlo, x);
+		vhi = _mm256_max_epi32(vhi, x);
+	}
+	_mm256_store_si256((__m256i *)lo, vlo);
+	_mm256_store_si256((__m256i *)hi, vhi);
+	fold(lo, hi, 8, v + i, n - i, min, max);
+}
+
+__attribute__((target("avx2")))
+static void avx2_moments(const int64_t *t, const int32_t *v, int n, int64_t t0, struct device_moments *m)
+{
+	double r[5][4] __attribute__((aligned(32)));
+	const __m256i base = _mm256_set1_epi64x(MAGIC_BITS - t0);
+	const __m256d magic = _mm256_set1_pd(MAGIC);
+	__m256d sx, sxx, sy, syy, sxy, x, y;
+	int i;
+
+	sx = sxx = sy = syy = sxy = _mm256_setzero_pd();
+	for (i = 0; i + 4 <= n; i += 4) {
+		x = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(_mm256_loadu_si256((const __m256i *)(t + i)), base)), magic);
+		y = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)(v + i)));
+		sx = _mm256_add_pd(sx, x);
+		sxx = _mm256_add_pd(sxx, _mm256_mul_pd(x, x));
+		sy = _mm256_add_pd(sy, y);
+		syy = _mm256_add_pd(syy, _mm256_mul_pd(y, y));
+		sxy = _mm256_add_pd(sxy, _mm256_mul_pd(x, y));
+	}
+	_mm256_store_pd(r[0], sx);
+	_mm256_store_pd(r[1], sxx);
+	_mm256_store_pd(r[2], sy);
+	_mm256_store_pd(r[3], syy);
+	_mm256_store_pd(r[4], sxy);
+	m->sx += r[0][0] + r[0][1] + r[0][2] + r[0][3];
+	m->sxx += r[1][0] + r[1][1] + r[1][2] + r[1][3];
+	m->sy += r[2][0] + r[2][1] + r[2][2] + r[2][3];
+	m->syy += r[3][0] + r[3][1] + r[3][2] + r[3][3];
+	m->sxy += r[4][0] + r[4][1] + r[4][2] + r[4][3];
+
+	scalar_moments(t + i, v + i, n - i, t0, m);
+}
+
+static const struct device_kernels _avx2 = {
+	.name = "avx2",
+	.minmax = avx2_minmax,
+	.moments = avx2_moments,
+};
+
+const struct device_kernels *const _device_kernels_all[] = { &_scalar, &_sse2, &_avx2, NULL };
+
+#elif defined(SIMD_NEON)
+
+static void neon_minmax(const int32_t *v, int n, int32_t *min, int32_t *max)
+{
+	int32_t lo[4], hi[4];
+	int32x4_t vlo, vhi, x;
+	int i;
+
+	if (n < 4) {
+		scalar_minmax(v, n, min, max);
+		return;
+	}
+
+	vlo = vhi = vld1q_s32(v);
+	for (i = 4; i + 4 <= n; i += 4) {
+		x = vld1q_s32(v + i);
+		vlo = vminq_s32(vlo, x);
+		vhi = vmaxq_s32(vhi, x);
+	}
+	vst1q_s32(lo, vlo);
+	vst1q_s32(hi, vhi);
+	fold(lo, hi, 4, v + i, n - i, min, max);
+}
+
+#ifdef __aarch64__
+static void neon_moments(const int64_t *t, const int32_t *v, int n, int64_t t0, struct device_moments *m)
+{
+	const int64x2_t base = vdupq_n_s64(t0);
+	float64x2_t sx, sxx, sy, syy, sxy, x, y;
+	int i;
+
+	sx = sxx = sy = syy = sxy = vdupq_n_f64(0);
+	for (i = 0; i + 2 <= n; i += 2) {
+		x = vcvtq_f64_s64(vsubq_s64(vld1q_s64(t + i), base));
+		y = vcvtq_f64_s64(vmovl_s32(vld1_s32(v + i)));
+		sx = vaddq_f64(sx, x);
+		sxx = vaddq_f64(sxx, vmulq_f64(x, x));
+		sy = vaddq_f64(sy, y);
+		syy = vaddq_f64(syy, vmulq_f64(y, y));
+		sxy = vaddq_f64(sxy, vmulq_f64(x, y));
+	}
+	m->sx += vaddvq_f64(sx);
+	m->sxx += vaddvq_f64(sxx);
+	m->sy += vaddvq_f64(sy);
+	m->syy += vaddvq_f64(syy);
+	m->sxy += vaddvq_f64(sxy);
+
+	scalar_moments(t + i, v + i, n - i, t0, m);
+}
+#else
+#define neon_moments scalar_moments
+#endif
+
+static const struct device_kernels _neon = {
+	.name = "neon",
+	.minmax = neon_minmax,
+	.moments = neon_moments,
+};
+
+const struct device_kernels *const _device_kernels_all[] = { &_scalar, &_neon, NULL };
+
+#else
+
+const struct device_kernels *const _device_kernels_all[] = { &_scalar, NULL };
+
+#endif
+
+static const struct device_kernels *_best = &_scalar;
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+static void kernels_select(void)
+{
+#ifdef SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		_best = &_avx2;
+	else if (__builtin_cpu_supports("sse2"))
+		_best = &_sse2;
+#elif defined(SIMD_NEON)
+	_best = &_neon;
+#endif
+}
+
+const struct device_kernels *_device_kernels(void)
+{
+	pthread_once(&_once, kernels_select);
+	return _best;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+/* The tracked properties, in the order device_changes_since() reports them */
+static const device_prop_e _tracked[] = {
+	DEVICE_PROP_BATTERY_PERCENT,
+	DEVICE_PROP_BATTERY_CHARGING,
+	DEVICE_PROP_BATTERY_WARNING,
+	DEVICE_PROP_DISPLAY0_BRIGHTNESS,
+	DEVICE_PROP_DISPLAY1_BRIGHTNESS,
+	DEVICE_PROP_FLASH_BRIGHTNESS,
+};
+
+#define TRACKED_MAX (sizeof(_tracked) / sizeof(_tracked[0]))
+
+struct state_field {
+	unsigned int generation;	/* generation of the last change, 0 if never observed */
+	int value;
+};
+
+static struct state_field _fields[DEVICE_PROP_MAX];
+static unsigned int _generation;
+static bool _tracking;
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+void _device_state_update(device_prop_e prop, int value)
+{
+	if (prop < 0 || prop >= DEVICE_PROP_MAX)
+		return;
+
+	/* Every getter and setter lands here, keep it lock free until tracking starts */
+	if (!__atomic_load_n(&_tracking, __ATOMIC_ACQUIRE))
+		return;
+
+	pthread_mutex_lock(&_lock);
+	if (_tracking && (_fields[prop].generation == 0 || _fields[prop].value != value)) {
+		_fields[prop].generation = ++_generation;
+		_fields[prop].value = value;
+	}
+	pthread_mutex_unlock(&_lock);
+}
+
+static void state_changed_inside_cb(device_event_e event, int value, unsigned long long stamp, void* user_data)
+{
+	device_battery_warn_e status;
+
+	switch (event) {
+	case DEVICE_EVENT_BATTERY_CAPACITY:
+		_device_state_update(DEVICE_PROP_BATTERY_PERCENT, value);
+		break;
+	case DEVICE_EVENT_BATTERY_CHARGING:
+		_device_state_update(DEVICE_PROP_BATTERY_CHARGING, value);
+		break;
+	case DEVICE_EVENT_BATTERY_WARNING:
+		if (_device_battery_warn_status(value, &status) == 0)
+			_device_state_update(DEVICE_PROP_BATTERY_WARNING, status);
+		break;
+	default:
+		break;
+	}
+}
+
+static int start_tracking(void)
+{
+	device_value_s values[TRACKED_MAX];
+	unsigned int i;
+
+	pthread_mutex_lock(&_lock);
+	if (_tracking) {
+		pthread_mutex_unlock(&_lock);
+		return 0;
+	}
+	__atomic_store_n(&_tracking, true, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&_lock);
+
+	if (_device_event_subscribe(DEVICE_EVENT_BATTERY_CAPACITY, state_changed_inside_cb, NULL) < 0 ||
+			_device_event_subscribe(DEVICE_EVENT_BATTERY_CHARGING, state_changed_inside_cb, NULL) < 0 ||
+			_device_event_subscribe(DEVICE_EVENT_BATTERY_WARNING, state_changed_inside_cb, NULL) < 0) {
+		_device_event_unsubscribe(DEVICE_EVENT_BATTERY_CAPACITY, state_changed_inside_cb, NULL);
+		_device_event_unsubscribe(DEVICE_EVENT_BATTERY_CHARGING, state_changed_inside_cb, NULL);
+		_device_event_unsubscribe(DEVICE_EVENT_BATTERY_WARNING, state_changed_inside_cb, NULL);
+		pthread_mutex_lock(&_lock);
+		__atomic_store_n(&_tracking, false, __ATOMIC_RELEASE);
+		pthread_mutex_unlock(&_lock);
+		return -1;
+	}
+
+	/* Seed the initial state so that generation 0 reports everything */
+	if (device_query(_tracked, TRACKED_MAX, values) == DEVICE_ERROR_NONE) {
+		for (i = 0; i < TRACKED_MAX; i++) {
+			if (values[i].error == DEVICE_ERROR_NONE)
+				_device_state_update(values[i].key, values[i].value);
+		}
+	}
+	return 0;
+}
+
+int device_changes_since(unsigned int generation, unsigned int *current_generation,
+		device_value_s *values, int max_count, int *count)
+{
+	unsigned int i, current;
+	int n = 0;
+	struct state_field *field;
+
+	if (current_generation == NULL || values == NULL || max_count <= 0 || count == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	if (start_tracking() < 0)
+		RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+
+	pthread_mutex_lock(&_lock);
+	current = _generation;
+	for (i = 0; i < TRACKED_MAX; i++) {
+		field = &_fields[_tracked[i]];
+		if (field->generation == 0 || field->generation <= generation)
+			continue;
+
+		/* No room left: make the next call report this change again */
+		if (n == max_count) {
+			if (field->generation - 1 < current)
+				current = field->generation - 1;
+			continue;
+		}
+
+		values[n].key = _tracked[i];
+		values[n].error = DEVICE_ERROR_NONE;
+		values[n].value = field->value;
+		n++;
+	}
+	*current_generation = current;
+	pthread_mutex_unlock(&_lock);
+
+	*count = n;
+	return DEVICE_ERROR_NONE;
+}
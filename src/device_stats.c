@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+/* Updated with atomic increments only, the notification path never takes a lock */
+static device_callback_stats_s _stats[DEVICE_CALLBACK_MAX];
+
+unsigned long long _device_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static int bucket(unsigned long long us)
+{
+	int idx = 0;
+
+	while (us > 1 && idx < DEVICE_CALLBACK_HISTOGRAM_MAX - 1) {
+		us >>= 1;
+		idx++;
+	}
+	return idx;
+}
+
+void _device_callback_delivered(device_callback_e callback, unsigned long long stamp,
+		unsigned long long entry, unsigned long long exit)
+{
+	device_callback_stats_s *stats = &_stats[callback];
+
+	__sync_fetch_and_add(&stats->delivered, 1);
+	__sync_fetch_and_add(&stats->latency[bucket(entry > stamp ? entry - stamp : 0)], 1);
+	__sync_fetch_and_add(&stats->duration[bucket(exit > entry ? exit - entry : 0)], 1);
+}
+
+void _device_callback_dropped(device_callback_e callback)
+{
+	__sync_fetch_and_add(&_stats[callback].dropped, 1);
+}
+
+void _device_callback_queued(device_callback_e callback, unsigned int depth)
+{
+	unsigned int max = _stats[callback].queue_max;
+
+	while (depth > max) {
+		if (__sync_bool_compare_and_swap(&_stats[callback].queue_max, max, depth))
+			break;
+		max = _stats[callback].queue_max;
+	}
+}
+
+void _device_callback_overflow(device_callback_e callback)
+{
+	__sync_fetch_and_add(&_stats[callback].overflow, 1);
+}
+
+void _device_callback_coalesced(device_callback_e callback, unsigned int count)
+{
+	__sync_fetch_and_add(&_stats[callback].coalesced, count);
+}
+
+int device_callback_get_stats(device_callback_e callback, device_callback_stats_s *stats)
+{
+	if (callback < 0 || callback >= DEVICE_CALLBACK_MAX || stats == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	/* A snapshot taken while a delivery is accounted may be off by one */
+	memcpy(stats, &_stats[callback], sizeof(*stats));
+	return DEVICE_ERROR_NONE;
+}
+
+int device_callback_reset_stats(device_callback_e callback)
+{
+	if (callback < 0 || callback >= DEVICE_CALLBACK_MAX)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	memset(&_stats[callback], 0, sizeof(_stats[callback]));
+	return DEVICE_ERROR_NONE;
+}
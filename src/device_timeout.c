@@ -0,0 +1,442 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+/*
+ * Call deadlines.
+ *
+ * devman and vconf calls can not be interrupted, so a backend call made
+ * under a deadline is handed to a caller thread of a small pool and the
+ * caller waits for it until the deadline. A call that times out keeps its
+ * caller thread until the backend returns, then its result is dropped;
+ * the arguments and results live in the caller thread, never on the stack
+ * of the timed out caller. Without a deadline, which is the default,
+ * backend calls are made directly and the pool is never started.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+#define CALLER_MAX 4
+
+typedef enum {
+	CALL_DISPLAY_COUNT,
+	CALL_DISPLAY_GET_BRT,
+	CALL_DISPLAY_SET_BRT,
+	CALL_DISPLAY_GET_MAX_BRT,
+	CALL_DISPLAY_RELEASE_BRT,
+	CALL_BATTERY_GET_PCT,
+	CALL_BATTERY_GET_PCT_RAW,
+	CALL_BATTERY_IS_FULL,
+	CALL_LED_GET_BRT,
+	CALL_LED_SET_BRT,
+	CALL_LED_GET_MAX,
+	CALL_VCONF_GET_INT,
+} call_op_e;
+
+typedef enum {
+	CALLER_IDLE,
+	CALLER_QUEUED,		/* handed to the caller thread */
+	CALLER_RUNNING,
+	CALLER_DONE,
+	CALLER_ABANDONED,	/* timed out while running, goes idle when the backend returns */
+} caller_state_e;
+
+struct call {
+	call_op_e op;
+	int arg;
+	int value;
+	const char *key;	/* vconf keys are string constants */
+	int ret;
+	int out;
+};
+
+struct caller {
+	caller_state_e state;
+	struct call call;
+	pthread_cond_t cond;
+};
+
+static const struct device_backend *_inner;
+static struct caller _callers[CALLER_MAX];
+static int _count;
+
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _cond;	/* a call completed or a caller went idle */
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+static int _timeout_ms;
+static __thread int _thread_timeout_ms = DEVICE_TIMEOUT_DEFAULT;
+static __thread struct {
+	int depth;
+	int timed_out;
+	unsigned long long deadline;
+} _call;
+
+static void timeout_init(void)
+{
+	const char *env = secure_getenv("CAPI_SYSTEM_DEVICE_TIMEOUT");
+	pthread_condattr_t attr;
+	int i;
+
+	if (env != NULL && atoi(env) > 0)
+		_timeout_ms = atoi(env);
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&_cond, &attr);
+	for (i = 0; i < CALLER_MAX; i++)
+		pthread_cond_init(&_callers[i].cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+static void execute(struct call *c)
+{
+	switch (c->op) {
+	case CALL_DISPLAY_COUNT:
+		c->ret = _inner->display_count();
+		break;
+	case CALL_DISPLAY_GET_BRT:
+		c->ret = _inner->display_get_brt(c->arg);
+		break;
+	case CALL_DISPLAY_SET_BRT:
+		c->ret = _inner->display_set_brt(c->arg, c->value);
+		break;
+	case CALL_DISPLAY_GET_MAX_BRT:
+		c->ret = _inner->display_get_max_brt(c->arg);
+		break;
+	case CALL_DISPLAY_RELEASE_BRT:
+		c->ret = _inner->display_release_brt(c->arg);
+		break;
+	case CALL_BATTERY_GET_PCT:
+		c->ret = _inner->battery_get_pct();
+		break;
+	case CALL_BATTERY_GET_PCT_RAW:
+		c->ret = _inner->battery_get_pct_raw();
+		break;
+	case CALL_BATTERY_IS_FULL:
+		c->ret = _inner->battery_is_full();
+		break;
+	case CALL_LED_GET_BRT:
+		c->ret = _inner->led_get_brt();
+		break;
+	case CALL_LED_SET_BRT:
+		c->ret = _inner->led_set_brt(c->value);
+		break;
+	case CALL_LED_GET_MAX:
+		c->ret = _inner->led_get_max();
+		break;
+	case CALL_VCONF_GET_INT:
+		c->ret = _inner->vconf_get_int(c->key, &c->out);
+		break;
+	}
+}
+
+static void *caller_main(void *data)
+{
+	struct caller *caller = data;
+	struct call call;
+
+	pthread_mutex_lock(&_lock);
+	for (;;) {
+		while (caller->state != CALLER_QUEUED)
+			pthread_cond_wait(&caller->cond, &_lock);
+		caller->state = CALLER_RUNNING;
+		call = caller->call;
+		pthread_mutex_unlock(&_lock);
+
+		execute(&call);
+
+		pthread_mutex_lock(&_lock);
+		caller->call = call;
+		caller->state = (caller->state == CALLER_ABANDONED) ? CALLER_IDLE : CALLER_DONE;
+		pthread_cond_broadcast(&_cond);
+	}
+	pthread_mutex_unlock(&_lock);
+	return NULL;
+}
+
+/* Called with _lock held */
+static struct caller *caller_get(void)
+{
+	pthread_t th;
+	int i;
+
+	for (i = 0; i < _count; i++) {
+		if (_callers[i].state == CALLER_IDLE)
+			return &_callers[i];
+	}
+
+	if (_count == CALLER_MAX)
+		return NULL;
+	if (pthread_create(&th, NULL, caller_main, &_callers[_count]) != 0)
+		return NULL;
+	pthread_detach(th);
+	return &_callers[_count++];
+}
+
+static void to_timespec(unsigned long long us, struct timespec *ts)
+{
+	ts->tv_sec = us / 1000000ULL;
+	ts->tv_nsec = (us % 1000000ULL) * 1000;
+}
+
+/* Runs a call on a caller thread and waits for it until the deadline of the thread */
+static int run(struct call *c)
+{
+	struct caller *caller;
+	struct timespec ts;
+	int err = 0;
+
+	if (_device_now_us() >= _call.deadline)
+		goto expired;
+	to_timespec(_call.deadline, &ts);
+
+	pthread_mutex_lock(&_lock);
+	while ((caller = caller_get()) == NULL && err != ETIMEDOUT)
+		err = pthread_cond_timedwait(&_cond, &_lock, &ts);
+	if (caller == NULL)
+		goto timed_out;
+
+	caller->call = *c;
+	caller->state = CALLER_QUEUED;
+	pthread_cond_signal(&caller->cond);
+
+	while ((caller->state == CALLER_QUEUED || caller->state == CALLER_RUNNING) && err != ETIMEDOUT)
+		err = pthread_cond_timedwait(&_cond, &_lock, &ts);
+	if (caller->state == CALLER_QUEUED) {
+		/* Never started, so it never reaches the device */
+		caller->state = CALLER_IDLE;
+		goto timed_out;
+	}
+	if (caller->state == CALLER_RUNNING) {
+		caller->state = CALLER_ABANDONED;
+		goto timed_out;
+	}
+
+	*c = caller->call;
+	caller->state = CALLER_IDLE;
+	pthread_cond_broadcast(&_cond);
+	pthread_mutex_unlock(&_lock);
+	return c->ret;
+
+timed_out:
+	pthread_mutex_unlock(&_lock);
+expired:
+	LOGE("[%s] backend call %d timed out", __FUNCTION__, c->op);
+	_call.timed_out = 1;
+	return -1;
+}
+
+#define GUARD(...) \
+	do { \
+		struct call __c = { __VA_ARGS__ }; \
+		if (_call.deadline == 0) { \
+			execute(&__c); \
+			return __c.ret; \
+		} \
+		return run(&__c); \
+	} while (0)
+
+static int guard_display_count(void)
+{
+	GUARD(.op = CALL_DISPLAY_COUNT);
+}
+
+static int guard_display_get_brt(int disp)
+{
+	GUARD(.op = CALL_DISPLAY_GET_BRT, .arg = disp);
+}
+
+static int guard_display_set_brt(int disp, int value)
+{
+	GUARD(.op = CALL_DISPLAY_SET_BRT, .arg = disp, .value = value);
+}
+
+static int guard_display_get_max_brt(int disp)
+{
+	GUARD(.op = CALL_DISPLAY_GET_MAX_BRT, .arg = disp);
+}
+
+static int guard_display_release_brt(int disp)
+{
+	GUARD(.op = CALL_DISPLAY_RELEASE_BRT, .arg = disp);
+}
+
+static int guard_battery_get_pct(void)
+{
+	GUARD(.op = CALL_BATTERY_GET_PCT);
+}
+
+static int guard_battery_get_pct_raw(void)
+{
+	GUARD(.op = CALL_BATTERY_GET_PCT_RAW);
+}
+
+static int guard_battery_is_full(void)
+{
+	GUARD(.op = CALL_BATTERY_IS_FULL);
+}
+
+static int guard_led_get_brt(void)
+{
+	GUARD(.op = CALL_LED_GET_BRT);
+}
+
+static int guard_led_set_brt(int value)
+{
+	GUARD(.op = CALL_LED_SET_BRT, .value = value);
+}
+
+static int guard_led_get_max(void)
+{
+	GUARD(.op = CALL_LED_GET_MAX);
+}
+
+static int guard_vconf_get_int(const char *key, int *value)
+{
+	struct call c = { .op = CALL_VCONF_GET_INT, .key = key };
+
+	if (_call.deadline == 0)
+		return _inner->vconf_get_int(key, value);
+
+	if (run(&c) < 0)
+		return -1;
+	*value = c.out;
+	return c.ret;
+}
+
+/* Registrations are not guarded: they are made once and do not wait on the device */
+static int guard_vconf_notify(const char *key, vconf_callback_fn cb, void *data)
+{
+	return _inner->vconf_notify(key, cb, data);
+}
+
+static int guard_vconf_ignore(const char *key, vconf_callback_fn cb)
+{
+	return _inner->vconf_ignore(key, cb);
+}
+
+static int guard_keynode_get_int(const keynode_t *key)
+{
+	return _inner->keynode_get_int(key);
+}
+
+static struct device_backend _timeout_backend = {
+	.display_count = guard_display_count,
+	.display_get_brt = guard_display_get_brt,
+	.display_set_brt = guard_display_set_brt,
+	.display_get_max_brt = guard_display_get_max_brt,
+	.display_release_brt = guard_display_release_brt,
+	.battery_get_pct = guard_battery_get_pct,
+	.battery_get_pct_raw = guard_battery_get_pct_raw,
+	.battery_is_full = guard_battery_is_full,
+	.led_get_brt = guard_led_get_brt,
+	.led_set_brt = guard_led_set_brt,
+	.led_get_max = guard_led_get_max,
+	.vconf_get_int = guard_vconf_get_int,
+	.vconf_notify = guard_vconf_notify,
+	.vconf_ignore = guard_vconf_ignore,
+	.keynode_get_int = guard_keynode_get_int,
+};
+
+const struct device_backend *_device_timeout_backend(const struct device_backend *inner)
+{
+	_inner = inner;
+	_timeout_backend.name = inner->name;
+	return &_timeout_backend;
+}
+
+unsigned long long _device_call_deadline(void)
+{
+	int timeout_ms = _thread_timeout_ms;
+
+	if (timeout_ms == DEVICE_TIMEOUT_DEFAULT) {
+		pthread_once(&_once, timeout_init);
+		timeout_ms = __atomic_load_n(&_timeout_ms, __ATOMIC_RELAXED);
+	}
+
+	return timeout_ms > 0 ? _device_now_us() + timeout_ms * 1000ULL : 0;
+}
+
+void _device_call_begin_at(unsigned long long deadline)
+{
+	if (_call.depth++ > 0)
+		return;
+
+	_call.deadline = deadline;
+	_call.timed_out = 0;
+	if (deadline != 0)
+		pthread_once(&_once, timeout_init);
+}
+
+void _device_call_begin(void)
+{
+	if (_call.depth > 0)
+		_call.depth++;
+	else
+		_device_call_begin_at(_device_call_deadline());
+}
+
+int _device_call_end(int ret)
+{
+	int timed_out = _call.timed_out;
+
+	if (--_call.depth == 0) {
+		_call.deadline = 0;
+		_call.timed_out = 0;
+	}
+
+	return (timed_out && ret < 0) ? DEVICE_ERROR_TIMED_OUT : ret;
+}
+
+unsigned long long _device_call_armed(void)
+{
+	return _call.deadline;
+}
+
+int _device_call_timed_out(void)
+{
+	return _call.timed_out;
+}
+
+int device_set_timeout(int timeout_ms)
+{
+	if (timeout_ms < 0)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	pthread_once(&_once, timeout_init);
+	__atomic_store_n(&_timeout_ms, timeout_ms, __ATOMIC_RELAXED);
+	return DEVICE_ERROR_NONE;
+}
+
+int device_set_thread_timeout(int timeout_ms)
+{
+	if (timeout_ms < 0 && timeout_ms != DEVICE_TIMEOUT_DEFAULT)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	_thread_timeout_ms = timeout_ms;
+	return DEVICE_ERROR_NONE;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define LOG_TAG "TIZEN_SYSTEM_DEVICE"
+
+/*
+ * One-shot waits for the next notification of an event.
+ *
+ * Waiters live in storage owned by the caller and are chained in a list
+ * per event, so a wait allocates nothing and any number of them share a
+ * single handler on the internal dispatcher. The handler is subscribed
+ * with the first wait on an event and then stays, so that a loop of waits
+ * does not register the vconf key again for every notification.
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <device.h>
+#include <dlog.h>
+#include <device_private.h>
+
+static const device_event_e _wait_events[DEVICE_WAIT_MAX] = {
+	[DEVICE_WAIT_BATTERY_CAPACITY] = DEVICE_EVENT_BATTERY_CAPACITY,
+	[DEVICE_WAIT_BATTERY_CHARGING] = DEVICE_EVENT_BATTERY_CHARGING,
+	[DEVICE_WAIT_BATTERY_WARNING] = DEVICE_EVENT_BATTERY_WARNING,
+};
+
+/*
+ * A notification being delivered. It takes the waiters of its event at
+ * once, so that a callback waiting again waits for the next notification,
+ * and then invokes them one at a time: each is unlinked and marked done
+ * under _lock right before its callback, so that until then a cancel
+ * still finds it pending and takes it out.
+ */
+struct wait_dispatch {
+	device_waiter_s *waiters;
+	device_waiter_s *current;	/* whose callback is running */
+	pthread_t thread;
+	struct wait_dispatch *next;
+};
+
+static device_waiter_s *_waiters[DEVICE_WAIT_MAX];
+static struct wait_dispatch *_dispatches[DEVICE_WAIT_MAX];
+static int _subscribed[DEVICE_WAIT_MAX];
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _done = PTHREAD_COND_INITIALIZER;
+
+/* Called with _lock held */
+static int wait_unlink(device_waiter_s **head, device_waiter_s *waiter)
+{
+	device_waiter_s **p;
+
+	for (p = head; *p != NULL; p = &(*p)->next) {
+		if (*p == waiter) {
+			*p = waiter->next;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+static void wait_changed_inside_cb(device_event_e event, int value, unsigned long long stamp, void *data)
+{
+	device_wait_e wait = (device_wait_e)(long)data;
+	device_battery_warn_e status;
+	struct wait_dispatch d, **p;
+	device_waiter_s *w;
+	device_wait_cb callback;
+	void *user_data;
+
+	/* Values a waiter cannot use leave it waiting for the next one */
+	if (wait == DEVICE_WAIT_BATTERY_WARNING) {
+		if (_device_battery_warn_status(value, &status) < 0)
+			return;
+		value = status;
+	} else if (wait == DEVICE_WAIT_BATTERY_CHARGING && value != 0 && value != 1) {
+		return;
+	}
+
+	pthread_mutex_lock(&_lock);
+	d.waiters = _waiters[wait];
+	d.current = NULL;
+	d.thread = pthread_self();
+	d.next = _dispatches[wait];
+	_waiters[wait] = NULL;
+	_dispatches[wait] = &d;
+
+	while ((w = d.waiters) != NULL) {
+		d.waiters = w->next;
+		callback = w->callback;
+		user_data = w->user_data;
+		w->pending = 0;
+		d.current = w;
+		pthread_mutex_unlock(&_lock);
+
+		/* The waiter is free for the callback, a cancel from elsewhere waits for it to return */
+		callback(DEVICE_ERROR_NONE, value, user_data);
+
+		pthread_mutex_lock(&_lock);
+		d.current = NULL;
+		pthread_cond_broadcast(&_done);
+	}
+
+	for (p = &_dispatches[wait]; *p != &d; p = &(*p)->next)
+		;
+	*p = d.next;
+	pthread_mutex_unlock(&_lock);
+}
+
+int device_wait_once(device_wait_e event, device_waiter_s *waiter, device_wait_cb callback, void *user_data)
+{
+	if (event < 0 || event >= DEVICE_WAIT_MAX || waiter == NULL || callback == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	pthread_mutex_lock(&_lock);
+	if (!_subscribed[event]) {
+		if (_device_event_subscribe(_wait_events[event], wait_changed_inside_cb, (void *)(long)event) < 0) {
+			pthread_mutex_unlock(&_lock);
+			RETURN_ERR(DEVICE_ERROR_OPERATION_FAILED);
+		}
+		_subscribed[event] = 1;
+	}
+
+	waiter->event = event;
+	waiter->callback = callback;
+	waiter->user_data = user_data;
+	waiter->pending = 1;
+	waiter->next = _waiters[event];
+	_waiters[event] = waiter;
+	pthread_mutex_unlock(&_lock);
+
+	return DEVICE_ERROR_NONE;
+}
+
+/* Called with _lock held, the dispatch running the callback of a waiter in another thread */
+static struct wait_dispatch *wait_running(device_waiter_s *waiter)
+{
+	struct wait_dispatch *d;
+
+	for (d = _dispatches[waiter->event]; d != NULL; d = d->next) {
+		if (d->current == waiter && !pthread_equal(d->thread, pthread_self()))
+			return d;
+	}
+	return NULL;
+}
+
+int device_wait_cancel(device_waiter_s *waiter)
+{
+	struct wait_dispatch *d;
+
+	if (waiter == NULL)
+		RETURN_ERR(DEVICE_ERROR_INVALID_PARAMETER);
+
+	/* Not an error worth a log, callers cancel whatever may still be pending */
+	pthread_mutex_lock(&_lock);
+	if (waiter->event < 0 || waiter->event >= DEVICE_WAIT_MAX) {
+		pthread_mutex_unlock(&_lock);
+		return DEVICE_ERROR_INVALID_PARAMETER;
+	}
+
+	/*
+	 * Too late once the callback runs. Unless that is in this very thread,
+	 * wait for it to return so the storage is not released under it; the
+	 * dispatch is looked up again after each wake up, it may be gone.
+	 */
+	while (!waiter->pending && wait_running(waiter) != NULL)
+		pthread_cond_wait(&_done, &_lock);
+
+	if (!waiter->pending) {
+		pthread_mutex_unlock(&_lock);
+		return DEVICE_ERROR_INVALID_PARAMETER;
+	}
+
+	if (wait_unlink(&_waiters[waiter->event], waiter) < 0) {
+		for (d = _dispatches[waiter->event]; d != NULL; d = d->next) {
+			if (wait_unlink(&d->waiters, waiter) == 0)
+				break;
+		}
+	}
+	waiter->pending = 0;
+	pthread_mutex_unlock(&_lock);
+
+	return DEVICE_ERROR_NONE;
+}
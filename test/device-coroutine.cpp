@@ -0,0 +1,122 @@
+/*
+ *
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ *
+ * This software is the confidential and proprietary information of SAMSUNG
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that
+ * this software is owned by Samsung and you shall not disclose such
+ * Confidential Information and shall use it only in accordance with the terms
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG
+ * make no representations or warranties about the suitability of the software,
+ * either express or implied, including but not limited to the implied
+ * warranties of merchantability, fitness for a particular purpose, or
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by
+ * licensee arising out of or related to this software.
+ *
+ */
+
+/*
+ * Awaits battery notifications and brightness requests from a coroutine
+ * that the main thread resumes, against the simulated device.
+ *
+ * usage: device-coroutine [changes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <device_coroutine.hpp>
+
+/* Resumes the posted coroutines in the thread that runs it */
+class Loop {
+public:
+	void post(std::coroutine_handle<> handle)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		queue_.push_back(handle);
+		cond_.notify_one();
+	}
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		while (!stopped_) {
+			if (queue_.empty()) {
+				cond_.wait(lock);
+				continue;
+			}
+			std::coroutine_handle<> handle = queue_.front();
+			queue_.pop_front();
+			lock.unlock();
+			handle.resume();
+			lock.lock();
+		}
+	}
+
+	void stop()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopped_ = true;
+		cond_.notify_one();
+	}
+
+private:
+	std::mutex mutex_;
+	std::condition_variable cond_;
+	std::deque<std::coroutine_handle<> > queue_;
+	bool stopped_ = false;
+};
+
+struct LoopExecutor {
+	Loop *loop;
+	void operator()(std::coroutine_handle<> handle) const { loop->post(handle); }
+};
+
+/* A coroutine that starts at once and frees itself when done */
+struct Task {
+	struct promise_type {
+		Task get_return_object() { return {}; }
+		std::suspend_never initial_suspend() { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { abort(); }
+	};
+};
+
+static Task watch(Loop &loop, int changes)
+{
+	LoopExecutor ex{ &loop };
+
+	for (int i = 0; i < changes; i++) {
+		device::Result<int> percent = co_await device::battery_changed(ex);
+		if (!percent) {
+			printf("battery wait failed : %d\n", percent.error());
+			break;
+		}
+		printf("battery %d%%\n", *percent);
+	}
+
+	device::Result<void> set = co_await device::set_brightness_async(0, 42, ex);
+	device::Result<int> value = co_await device::get_brightness_async(0, ex);
+	printf("brightness set %s, read %d\n", set ? "ok" : "failed", value.value_or(-1));
+
+	loop.stop();
+}
+
+int main(int argc, char *argv[])
+{
+	int changes = argc > 1 ? atoi(argv[1]) : 3;
+	Loop loop;
+
+	setenv("CAPI_SYSTEM_DEVICE_BACKEND", "sim", 1);
+	if (getenv("CAPI_SYSTEM_DEVICE_SIM") == NULL)
+		setenv("CAPI_SYSTEM_DEVICE_SIM", "rate=1000,discharge=100", 1);
+
+	watch(loop, changes);
+	loop.run();
+	return 0;
+}
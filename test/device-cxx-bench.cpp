@@ -0,0 +1,110 @@
+/*
+ *
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ *
+ * This software is the confidential and proprietary information of SAMSUNG
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that
+ * this software is owned by Samsung and you shall not disclose such
+ * Confidential Information and shall use it only in accordance with the terms
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG
+ * make no representations or warranties about the suitability of the software,
+ * either express or implied, including but not limited to the implied
+ * warranties of merchantability, fitness for a particular purpose, or
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by
+ * licensee arising out of or related to this software.
+ *
+ */
+
+/*
+ * Compares the brightness calls of device.hpp with the C calls they
+ * replace, against the mock device so that the library itself is measured.
+ * Display<0> should cost the same as device_get_brightness_unchecked() and
+ * less than device_get_brightness(), which also queries the display count.
+ *
+ * usage: device-cxx-bench [calls]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <device.hpp>
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int calls;
+static volatile int sink;
+
+template <typename F>
+static void run(const char *name, F f)
+{
+	unsigned long long start;
+	int i, failed = 0;
+
+	for (i = 0; i < calls / 10; i++)
+		f();
+
+	start = now_ns();
+	for (i = 0; i < calls; i++)
+		failed += f() ? 0 : 1;
+	printf("%-40s %8.1f ns/call%s\n", name, (double)(now_ns() - start) / calls,
+			failed ? " (failures)" : "");
+}
+
+int main(int argc, char *argv[])
+{
+	calls = argc > 1 ? atoi(argv[1]) : 1000000;
+	if (calls < 10) {
+		printf("usage: %s [calls]\n", argv[0]);
+		return 1;
+	}
+
+	setenv("CAPI_SYSTEM_DEVICE_BACKEND", "mock", 1);
+
+	run("device_get_brightness", [] {
+		int value;
+		bool ok = device_get_brightness(0, &value) == DEVICE_ERROR_NONE;
+		sink = value;
+		return ok;
+	});
+	run("device_get_brightness_unchecked", [] {
+		int value;
+		bool ok = device_get_brightness_unchecked(0, &value) == DEVICE_ERROR_NONE;
+		sink = value;
+		return ok;
+	});
+	run("device::Display<0>::brightness", [] {
+		device::Result<int> r = device::Display<0>::brightness();
+		sink = r.value_or(-1);
+		return r.has_value();
+	});
+
+	run("device_set_brightness", [] {
+		return device_set_brightness(0, 50) == DEVICE_ERROR_NONE;
+	});
+	run("device_set_brightness_unchecked", [] {
+		return device_set_brightness_unchecked(0, 50) == DEVICE_ERROR_NONE;
+	});
+	run("device::Display<0>::set_brightness", [] {
+		return device::Display<0>::set_brightness(50).has_value();
+	});
+
+	run("device_battery_get_percent", [] {
+		int value;
+		bool ok = device_battery_get_percent(&value) == DEVICE_ERROR_NONE;
+		sink = value;
+		return ok;
+	});
+	run("device::battery_percent", [] {
+		device::Result<int> r = device::battery_percent();
+		sink = r.value_or(-1);
+		return r.has_value();
+	});
+	return 0;
+}
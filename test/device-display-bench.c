@@ -0,0 +1,111 @@
+/*
+ *
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ *
+ * This software is the confidential and proprietary information of SAMSUNG
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that
+ * this software is owned by Samsung and you shall not disclose such
+ * Confidential Information and shall use it only in accordance with the terms
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG
+ * make no representations or warranties about the suitability of the software,
+ * either express or implied, including but not limited to the implied
+ * warranties of merchantability, fitness for a particular purpose, or
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by
+ * licensee arising out of or related to this software.
+ *
+ */
+
+/*
+ * Times the display calls of the main display against the mock device and
+ * counts the backend calls each one makes. Run it once with the generic
+ * library and once with a SINGLE_DISPLAY build (LD_LIBRARY_PATH) to compare
+ * them; mock options such as latency=<us> model the cost of a devman call.
+ *
+ * usage: device-display-bench [calls]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <device.h>
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int get_brightness(void)
+{
+	int value;
+
+	return device_get_brightness(0, &value);
+}
+
+static int set_brightness(void)
+{
+	return device_set_brightness(0, 50);
+}
+
+static int get_display_numbers(void)
+{
+	int count;
+
+	return device_get_display_numbers(&count);
+}
+
+static int set_brightness_percent(void)
+{
+	return device_set_brightness_percent(0, 50);
+}
+
+static const struct {
+	const char *name;
+	int (*func)(void);
+} _calls[] = {
+	{ "device_get_brightness", get_brightness },
+	{ "device_set_brightness", set_brightness },
+	{ "device_get_display_numbers", get_display_numbers },
+	{ "device_set_brightness_percent", set_brightness_percent },
+};
+
+int main(int argc, char *argv[])
+{
+	int calls = argc > 1 ? atoi(argv[1]) : 1000000;
+	device_subsystem_stats_s stats;
+	unsigned long long start, elapsed;
+	int i, n, count, failed;
+
+	if (calls < 1) {
+		printf("usage: %s [calls]\n", argv[0]);
+		return 1;
+	}
+
+	setenv("CAPI_SYSTEM_DEVICE_BACKEND", "mock", 1);
+
+	if (device_get_display_numbers(&count) != DEVICE_ERROR_NONE) {
+		printf("no display\n");
+		return 1;
+	}
+	printf("%d display(s)\n", count);
+
+	for (n = 0; n < (int)(sizeof(_calls) / sizeof(_calls[0])); n++) {
+		/* warm up the cached limits and curve tables */
+		_calls[n].func();
+		device_subsystem_reset_stats(DEVICE_SUBSYSTEM_DISPLAY);
+
+		failed = 0;
+		start = now_ns();
+		for (i = 0; i < calls; i++)
+			failed += _calls[n].func() != DEVICE_ERROR_NONE;
+		elapsed = now_ns() - start;
+
+		device_subsystem_get_stats(DEVICE_SUBSYSTEM_DISPLAY, &stats);
+		printf("%-32s %8.1f ns/call, %.2f backend calls/call%s\n", _calls[n].name,
+				(double)elapsed / calls, (double)stats.calls / calls, failed ? " (failures)" : "");
+	}
+	return 0;
+}
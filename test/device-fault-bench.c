@@ -0,0 +1,134 @@
+/*
+ *
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ *
+ * This software is the confidential and proprietary information of SAMSUNG
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that
+ * this software is owned by Samsung and you shall not disclose such
+ * Confidential Information and shall use it only in accordance with the terms
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG
+ * make no representations or warranties about the suitability of the software,
+ * either express or implied, including but not limited to the implied
+ * warranties of merchantability, fitness for a particular purpose, or
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by
+ * licensee arising out of or related to this software.
+ *
+ */
+
+/*
+ * Reads the display brightness from several threads, each polling once
+ * per millisecond, against the mock device with injected faults, and
+ * reports the success rate, the call latency and the backend load under
+ * the retry policy.
+ *
+ * usage: device-fault-bench [threads] [calls] [attempts] [mock options]
+ * e.g.   device-fault-bench 4 3000 3 fail=50,period=2000,down=300
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <device.h>
+
+#define THREAD_MAX 64
+#define CLIENT_PERIOD_US 1000
+
+static int calls;
+static unsigned long long latency[THREAD_MAX][32];
+static int ok[THREAD_MAX];
+
+static unsigned long long now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void *client(void *data)
+{
+	int id = (int)(long)data;
+	unsigned long long start, us;
+	int i, b, value;
+
+	for (i = 0; i < calls; i++) {
+		start = now_us();
+		if (device_get_brightness(0, &value) == DEVICE_ERROR_NONE)
+			ok[id]++;
+		us = now_us() - start;
+		for (b = 0; b < 31 && (2ULL << b) <= us; b++)
+			;
+		latency[id][b]++;
+		if (us < CLIENT_PERIOD_US)
+			usleep(CLIENT_PERIOD_US - us);
+	}
+	return NULL;
+}
+
+/* Upper bound of the bucket holding the given fraction of the calls */
+static unsigned long long percentile(const unsigned long long *total, unsigned long long count, double p)
+{
+	unsigned long long seen = 0;
+	int b;
+
+	for (b = 0; b < 32; b++) {
+		seen += total[b];
+		if (seen >= count * p)
+			return 2ULL << b;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int threads = argc > 1 ? atoi(argv[1]) : 4;
+	device_retry_policy_s policy;
+	device_subsystem_stats_s stats;
+	unsigned long long total[32] = { 0, }, start, elapsed;
+	pthread_t th[THREAD_MAX];
+	int i, b, succeeded = 0;
+
+	calls = argc > 2 ? atoi(argv[2]) : 2000;
+	if (threads < 1 || threads > THREAD_MAX || calls < 1) {
+		printf("usage: %s [threads] [calls] [attempts] [mock options]\n", argv[0]);
+		return 1;
+	}
+
+	setenv("CAPI_SYSTEM_DEVICE_BACKEND", "mock", 1);
+	setenv("CAPI_SYSTEM_DEVICE_MOCK", argc > 4 ? argv[4] : "fail=50,period=2000,down=300", 1);
+
+	device_get_retry_policy(&policy);
+	if (argc > 3)
+		policy.attempts = atoi(argv[3]);
+	if (device_set_retry_policy(&policy) != DEVICE_ERROR_NONE) {
+		printf("invalid retry policy\n");
+		return 1;
+	}
+
+	start = now_us();
+	for (i = 0; i < threads; i++)
+		pthread_create(&th[i], NULL, client, (void *)(long)i);
+	for (i = 0; i < threads; i++)
+		pthread_join(th[i], NULL);
+	elapsed = now_us() - start;
+
+	for (i = 0; i < threads; i++) {
+		succeeded += ok[i];
+		for (b = 0; b < 32; b++)
+			total[b] += latency[i][b];
+	}
+
+	device_subsystem_get_stats(DEVICE_SUBSYSTEM_DISPLAY, &stats);
+
+	printf("%d threads x %d calls, %d attempts : %.1f%% succeeded in %llums\n", threads, calls,
+			policy.attempts, 100.0 * succeeded / (threads * calls), elapsed / 1000);
+	printf("latency p50 < %lluus, p99 < %lluus\n",
+			percentile(total, (unsigned long long)threads * calls, 0.5),
+			percentile(total, (unsigned long long)threads * calls, 0.99));
+	printf("backend : %llu calls, %llu retries, %llu failures, %llu rejected, %llu trips\n",
+			stats.calls, stats.retries, stats.failures, stats.rejected, stats.trips);
+	return 0;
+}
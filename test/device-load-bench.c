@@ -0,0 +1,123 @@
+/*
+ * 
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ * 
+ * This software is the confidential and proprietary information of SAMSUNG 
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that 
+ * this software is owned by Samsung and you shall not disclose such 
+ * Confidential Information and shall use it only in accordance with the terms 
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG 
+ * make no representations or warranties about the suitability of the software, 
+ * either express or implied, including but not limited to the implied 
+ * warranties of merchantability, fitness for a particular purpose, or 
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by 
+ * licensee arising out of or related to this software.
+ * 
+ */
+
+/*
+ * Measures the cost of loading libcapi-system-device and of the first call
+ * into each subsystem, which is when its backend is resolved.
+ * The library is loaded with dlopen() so the load itself can be measured.
+ *
+ * usage: device-load-bench [library path]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <dlfcn.h>
+
+#define DEFAULT_LIBRARY "libcapi-system-device.so.0"
+
+static long rss_kb(void)
+{
+	char line[128];
+	long kb = -1;
+	FILE *fp = fopen("/proc/self/status", "r");
+
+	if (fp == NULL)
+		return -1;
+
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (strncmp(line, "VmRSS:", 6) == 0) {
+			kb = strtol(line + 6, NULL, 10);
+			break;
+		}
+	}
+	fclose(fp);
+	return kb;
+}
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void report(const char *what, double start, long rss_before)
+{
+	printf("%-12s %10.1f us %+8ld kB\n", what, now_us() - start, rss_kb() - rss_before);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *path = argc > 1 ? argv[1] : DEFAULT_LIBRARY;
+	void *handle;
+	double start;
+	long rss;
+	int value;
+	bool flag;
+	int (*get_display_numbers)(int *);
+	int (*battery_get_percent)(int *);
+	int (*flash_get_max_brightness)(int *);
+	int (*battery_is_charging)(bool *);
+
+	printf("%-12s %13s %11s\n", "step", "time", "rss");
+
+	rss = rss_kb();
+	start = now_us();
+	handle = dlopen(path, RTLD_NOW);
+	if (handle == NULL) {
+		printf("dlopen error : %s\n", dlerror());
+		return 1;
+	}
+	report("load", start, rss);
+
+	*(void **)&battery_get_percent = dlsym(handle, "device_battery_get_percent");
+	*(void **)&get_display_numbers = dlsym(handle, "device_get_display_numbers");
+	*(void **)&flash_get_max_brightness = dlsym(handle, "device_flash_get_max_brightness");
+	*(void **)&battery_is_charging = dlsym(handle, "device_battery_is_charging");
+	if (!battery_get_percent || !get_display_numbers || !flash_get_max_brightness || !battery_is_charging) {
+		printf("dlsym error : %s\n", dlerror());
+		return 1;
+	}
+
+	rss = rss_kb();
+	start = now_us();
+	battery_get_percent(&value);
+	report("battery", start, rss);
+
+	rss = rss_kb();
+	start = now_us();
+	get_display_numbers(&value);
+	report("display", start, rss);
+
+	rss = rss_kb();
+	start = now_us();
+	flash_get_max_brightness(&value);
+	report("led", start, rss);
+
+	rss = rss_kb();
+	start = now_us();
+	battery_is_charging(&flag);
+	report("vconf", start, rss);
+
+	dlclose(handle);
+	return 0;
+}
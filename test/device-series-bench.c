@@ -0,0 +1,124 @@
+/*
+ * 
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ * 
+ * This software is the confidential and proprietary information of SAMSUNG 
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that 
+ * this software is owned by Samsung and you shall not disclose such 
+ * Confidential Information and shall use it only in accordance with the terms 
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG 
+ * make no representations or warranties about the suitability of the software, 
+ * either express or implied, including but not limited to the implied 
+ * warranties of merchantability, fitness for a particular purpose, or 
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by 
+ * licensee arising out of or related to this software.
+ * 
+ */
+
+/*
+ * Compares the throughput of the battery series aggregation kernels.
+ * The kernels are built into the benchmark from src/device_simd.c, so it
+ * runs on any Linux machine without the platform libraries.
+ *
+ * usage: device-series-bench [samples] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <device_simd_private.h>
+
+#define DEFAULT_SAMPLES 50000
+#define DEFAULT_ROUNDS 2000
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* A slow discharge sampled about once a minute, with some noise */
+static void generate(int64_t *t, int32_t *v, int n)
+{
+	int64_t time = 1700000000000LL;
+	int i;
+
+	srand(1);
+	for (i = 0; i < n; i++) {
+		time += 55000 + rand() % 10000;
+		t[i] = time;
+		v[i] = 10000 - i / 10 + rand() % 7;
+	}
+}
+
+static int close_to(double a, double b)
+{
+	return fabs(a - b) <= 1e-9 * (fabs(a) + fabs(b)) + 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+	const struct device_kernels *const *k;
+	struct device_moments ref = { 0, }, m;
+	int32_t *v, min, max, ref_min, ref_max;
+	int64_t *t;
+	int n = argc > 1 ? atoi(argv[1]) : DEFAULT_SAMPLES;
+	int rounds = argc > 2 ? atoi(argv[2]) : DEFAULT_ROUNDS;
+	double start, minmax_us, moments_us, scalar_us = 0;
+	volatile int32_t sink;
+	int i, ok;
+
+	if (n <= 0 || rounds <= 0) {
+		fprintf(stderr, "usage: %s [samples] [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	t = malloc(n * sizeof(*t));
+	v = malloc(n * sizeof(*v));
+	if (t == NULL || v == NULL)
+		return 1;
+	generate(t, v, n);
+
+	_device_kernels_all[0]->minmax(v, n, &ref_min, &ref_max);
+	_device_kernels_all[0]->moments(t, v, n, t[0], &ref);
+
+	printf("%d samples, %d rounds, runtime choice: %s\n", n, rounds, _device_kernels()->name);
+	printf("%-8s %14s %14s %10s %8s\n", "kernels", "minmax Ms/s", "moments Ms/s", "speedup", "result");
+
+	for (k = _device_kernels_all; *k != NULL; k++) {
+		start = now_us();
+		for (i = 0; i < rounds; i++) {
+			(*k)->minmax(v, n, &min, &max);
+			sink = min;
+		}
+		minmax_us = now_us() - start;
+
+		start = now_us();
+		for (i = 0; i < rounds; i++) {
+			m = (struct device_moments){ 0, };
+			(*k)->moments(t, v, n, t[0], &m);
+			sink = (int32_t)m.sy;
+		}
+		moments_us = now_us() - start;
+		(void)sink;
+
+		if (k == _device_kernels_all)
+			scalar_us = minmax_us + moments_us;
+
+		ok = min == ref_min && max == ref_max && close_to(m.sx, ref.sx) && close_to(m.sxx, ref.sxx) &&
+			close_to(m.sy, ref.sy) && close_to(m.syy, ref.syy) && close_to(m.sxy, ref.sxy);
+
+		printf("%-8s %14.1f %14.1f %9.2fx %8s\n", (*k)->name,
+				(double)n * rounds / minmax_us, (double)n * rounds / moments_us,
+				scalar_us / (minmax_us + moments_us), ok ? "ok" : "MISMATCH");
+	}
+
+	free(t);
+	free(v);
+	return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * 
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ * 
+ * This software is the confidential and proprietary information of SAMSUNG 
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that 
+ * this software is owned by Samsung and you shall not disclose such 
+ * Confidential Information and shall use it only in accordance with the terms 
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG 
+ * make no representations or warranties about the suitability of the software, 
+ * either express or implied, including but not limited to the implied 
+ * warranties of merchantability, fitness for a particular purpose, or 
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by 
+ * licensee arising out of or related to this software.
+ * 
+ */
+
+/*
+ * Drives the battery and warning callbacks with the simulated device.
+ *
+ * usage: device-sim-load [seconds] [simulator options]
+ * e.g.   device-sim-load 5 rate=5000,flood=1,plug=300,unplug=700
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <device.h>
+
+static volatile unsigned long battery_events;
+static volatile unsigned long warn_events;
+static volatile int last_percent = -1;
+
+static void battery_cb(int percent, void *user_data)
+{
+	battery_events++;
+	last_percent = percent;
+}
+
+static void warn_cb(device_battery_warn_e status, void *user_data)
+{
+	warn_events++;
+}
+
+static void print_stats(const char *name, device_callback_e callback)
+{
+	device_callback_stats_s stats;
+	int i;
+
+	if (device_callback_get_stats(callback, &stats) != DEVICE_ERROR_NONE)
+		return;
+
+	printf("%s : delivered %u, dropped %u\n", name, stats.delivered, stats.dropped);
+	printf("  %-8s %10s %10s\n", "us", "latency", "duration");
+	for (i = 0; i < DEVICE_CALLBACK_HISTOGRAM_MAX; i++) {
+		if (stats.latency[i] == 0 && stats.duration[i] == 0)
+			continue;
+		printf("  <%-7u %10u %10u\n", 2u << i, stats.latency[i], stats.duration[i]);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int seconds = argc > 1 ? atoi(argv[1]) : 5;
+
+	setenv("CAPI_SYSTEM_DEVICE_BACKEND", "sim", 1);
+	setenv("CAPI_SYSTEM_DEVICE_SIM", argc > 2 ? argv[2] : "rate=1000,flood=1", 1);
+
+	if (device_battery_set_cb(battery_cb, NULL) != DEVICE_ERROR_NONE ||
+			device_battery_warning_set_cb(warn_cb, NULL) != DEVICE_ERROR_NONE) {
+		printf("fail to set callbacks\n");
+		return 1;
+	}
+
+	sleep(seconds);
+
+	device_battery_unset_cb();
+	device_battery_warning_unset_cb();
+
+	printf("battery callbacks : %lu (%.1f/s), last %d%%\n",
+			battery_events, (double)battery_events / seconds, last_percent);
+	printf("warning callbacks : %lu\n", warn_events);
+
+	print_stats("battery", DEVICE_CALLBACK_BATTERY);
+	print_stats("warning", DEVICE_CALLBACK_BATTERY_WARNING);
+	return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ *
+ * Copyright (c) 2011 Samsung Electronics Co., Ltd All Rights Reserved
+ * PROPRIETARY/CONFIDENTIAL
+ *
+ * This software is the confidential and proprietary information of SAMSUNG
+ * ELECTRONICS ("Confidential Information"). You agree and acknowledge that
+ * this software is owned by Samsung and you shall not disclose such
+ * Confidential Information and shall use it only in accordance with the terms
+ * of the license agreement you entered into with SAMSUNG ELECTRONICS. SAMSUNG
+ * make no representations or warranties about the suitability of the software,
+ * either express or implied, including but not limited to the implied
+ * warranties of merchantability, fitness for a particular purpose, or
+ * non-infringement. SAMSUNG shall not be liable for any damages suffered by
+ * licensee arising out of or related to this software.
+ *
+ */
+
+/*
+ * Destroys a coroutine suspended on a battery event while the notification
+ * is being delivered to another one, against the simulated device. The
+ * destroyed one must never be resumed; the program exits with 1 if it is.
+ * Build it with -fsanitize=address to also catch a late access to its frame.
+ *
+ * usage: device-wait-cancel [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <device_coroutine.hpp>
+
+static std::atomic<int> _delivering;
+static std::atomic<int> _destroyed;
+static std::atomic<int> _late;
+
+/* Delivers slowly, so the other waiter stays queued behind it */
+struct SlowExecutor {
+	void operator()(std::coroutine_handle<> handle) const
+	{
+		_delivering = 1;
+		while (!_destroyed)
+			usleep(100);
+		handle.resume();
+	}
+};
+
+/* Counts a resumption after the coroutine was destroyed */
+struct VictimExecutor {
+	void operator()(std::coroutine_handle<> handle) const
+	{
+		if (_destroyed)
+			_late++;
+		handle.resume();
+	}
+};
+
+/* A coroutine that starts at once and is destroyed by its owner */
+struct Task {
+	struct promise_type {
+		Task get_return_object() { return { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+		std::suspend_never initial_suspend() { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { abort(); }
+	};
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+template <typename Executor>
+static Task wait_once()
+{
+	co_await device::battery_changed(Executor());
+}
+
+int main(int argc, char *argv[])
+{
+	int rounds = argc > 1 ? atoi(argv[1]) : 100;
+	int i;
+
+	setenv("CAPI_SYSTEM_DEVICE_BACKEND", "sim", 1);
+	if (getenv("CAPI_SYSTEM_DEVICE_SIM") == NULL)
+		setenv("CAPI_SYSTEM_DEVICE_SIM", "rate=1000,discharge=100,charge=100,plug=20,unplug=20", 1);
+
+	for (i = 0; i < rounds; i++) {
+		_delivering = 0;
+		_destroyed = 0;
+
+		/* The latest wait is delivered first, so the victim queues behind the slow one */
+		Task victim = wait_once<VictimExecutor>();
+		Task slow = wait_once<SlowExecutor>();
+
+		while (!_delivering)
+			usleep(100);
+		victim.handle.destroy();
+		_destroyed = 1;
+
+		while (!slow.handle.done())
+			usleep(100);
+		slow.handle.destroy();
+	}
+
+	printf("%d rounds, %d destroyed coroutines resumed\n", rounds, _late.load());
+	return _late ? 1 : 0;
+}